@@ -76,6 +76,11 @@ class AIDAProcessor : public marlin::Processor {
    */
   virtual void end() ;
 
+  /** The AIDA tree is created with its file in init() and can't be split into worker 
+   *  files - no multi-process mode with the AIDAProcessor.
+   */
+  virtual bool allowWorkerProcesses() const { return false ; }
+
 
   /** Returns an AIDA histogram factory for the given processor with
    *  the current directory set to the processor's name.
@@ -83,6 +83,9 @@ namespace marlin {
     const std::string getDescription(){	return (isInstalled() ? _proc->description() : 
 	    "This processor is NOT installed in your Marlin binary: parameter descriptions and types lost!!");
     }
+
+    /** Returns the declared concurrency level of the processor, e.g. "SerialOnly" */
+    const std::string getConcurrencyDesc(){ return (isInstalled() ? Processor::concurrencyName( _proc->concurrency() ) : "unknown" ); }
     
     /* Returns a string vector with the errors of the processor - Obsolete: use getError() instead */
     //const StringVec& getErrors(){ return _errors; }
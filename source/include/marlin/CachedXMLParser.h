@@ -0,0 +1,75 @@
+#ifndef CachedXMLParser_h
+#define CachedXMLParser_h 1
+
+#include "marlin/IParser.h"
+#include "marlin/XMLParser.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace marlin{
+
+  /** Parser that keeps the fully resolved steering parameters of an XML steering file in a
+   *  binary cache file. The cache file is identified by a hash of the steering file name, its
+   *  content and the command line parameters; it is only used if the content hashes of
+   *  the steering file and of all included files are unchanged. Otherwise the file is
+   *  parsed with the XMLParser and the cache is (re-)written.
+   *
+   *  As the XML tree is not cached, write() parses the steering file if the parameters
+   *  have been read from the cache.
+   */
+  class CachedXMLParser : public IParser {
+
+  public:
+
+    /** Parse fileName - using cache files in the directory cacheDir */
+    CachedXMLParser( const std::string& fileName, const std::string& cacheDir ) ;
+    virtual ~CachedXMLParser() ;
+
+    CachedXMLParser( const CachedXMLParser& ) = delete ;
+    CachedXMLParser& operator=( const CachedXMLParser& ) = delete ;
+
+    /** set command line parameters */
+    void setCmdLineParameters( const CommandLineParametersMap & cmdlineparams ) ;
+
+    /** Read the parameters from the cache or parse the steering file */
+    void parse() ;
+
+    /** Return the StringParameters for the section */
+    std::shared_ptr<StringParameters> getParameters( const std::string& sectionName ) const ;
+
+    /** Write the parsed XML tree in an other file */
+    void write( const std::string& fname ) const ;
+
+    /** True if the parameters have been read from the cache */
+    bool fromCache() const { return _fromCache ; }
+
+    /** 64 bit FNV-1a hash of the given data */
+    static uint64_t hash( const std::string& data, uint64_t h=14695981039346656037ULL ) ;
+
+  protected:
+
+    /** Name of the cache file for the current steering file and command line parameters */
+    std::string cacheFileName() const ;
+
+    /** Read the cache file - false if it does not exist or is outdated */
+    bool readCache( const std::string& cacheFile ) ;
+
+    /** Write the cache file from the parsed parameters */
+    void writeCache( const std::string& cacheFile ) const ;
+
+    /** Parse the steering file with the XMLParser */
+    void parseXML() const ;
+
+    std::string _fileName ;
+    std::string _cacheDir ;
+    CommandLineParametersMap _cmdlineparams{} ;
+    mutable std::unique_ptr<XMLParser> _parser{} ;
+    mutable StringParametersMap _map{} ;
+    bool _fromCache = false ;
+  } ;
+
+} // end namespace marlin
+#endif
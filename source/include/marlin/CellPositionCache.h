@@ -0,0 +1,120 @@
+#ifndef CellPositionCache_h
+#define CellPositionCache_h 1
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gear{ class GearMgr ; }
+
+namespace marlin{
+
+  /** Geometry of a cell */
+  struct CellInfo {
+    float position[3] = { 0.f, 0.f, 0.f } ;
+    int layer = 0 ;
+    int module = 0 ;
+  } ;
+
+  /** Memoised cellID -> position, layer and module lookup for one subdetector, shared by
+   *  all processors and threads of the job. The geometry of a cell is computed once with
+   *  the calculator from the GEAR geometry of the pipeline; later lookups of the cell are a
+   *  hash map lookup in one of several independently locked shards or - for regular
+   *  segmentations with a dense cell index - an array access:
+   *
+   *  <pre>
+   *    _cells = CellPositionCache::get( "EcalBarrel", [this]( uint64_t cellID, const gear::GearMgr& gear ){
+   *        CellInfo info ;
+   *        const gear::CalorimeterParameters& cal = gear.getEcalBarrelParameters() ;
+   *        ... // decode the cellID and compute the position
+   *        return info ;
+   *      } ) ;
+   *
+   *    const CellInfo& cell = _cells->lookup( hit->getCellID0() ) ;
+   *  </pre>
+   *
+   *  The cache is held by the ResourceService of the pipeline; the hit rate is printed when
+   *  it is deleted at the end of the job.
+   */
+  class CellPositionCache {
+
+  public:
+
+    /** Computes the geometry of a cell */
+    typedef std::function< CellInfo( uint64_t cellID, const gear::GearMgr& gear ) > Calculator ;
+
+    /** Maps the cellIDs of a regular segmentation to a dense index in [0,size) - values
+     *  outside the range are looked up in the hash map.
+     */
+    typedef std::function< size_t( uint64_t cellID ) > DenseIndex ;
+
+    /** The cache with the given name for the pipeline - created with the calculator and the
+     *  GEAR geometry of the pipeline on the first call.
+     */
+    static std::shared_ptr<const CellPositionCache> get( const std::string& name, Calculator calc ) ;
+
+    /** As above with a dense table of the given size for the cells with a dense index */
+    static std::shared_ptr<const CellPositionCache> get( const std::string& name, Calculator calc,
+							 DenseIndex index, size_t size ) ;
+
+    CellPositionCache( const std::string& name, const gear::GearMgr* gear, Calculator calc,
+		       DenseIndex index=DenseIndex(), size_t denseSize=0 ) ;
+
+    /** Prints the hit rate */
+    ~CellPositionCache() ;
+
+    CellPositionCache( const CellPositionCache& ) = delete ;
+    CellPositionCache& operator=( const CellPositionCache& ) = delete ;
+
+    /** The geometry of the cell - computed on the first lookup. Thread safe, the reference
+     *  stays valid for the lifetime of the cache.
+     */
+    const CellInfo& lookup( uint64_t cellID ) const ;
+
+    /** Positions of n cells into the arrays x, y and z */
+    void lookup( const uint64_t* cellIDs, size_t n, float* x, float* y, float* z ) const ;
+
+    /** Number of lookups of cached cells */
+    uint64_t hits() const ;
+
+    /** Number of cells computed */
+    uint64_t misses() const ;
+
+    const std::string& name() const { return _name ; }
+
+  protected:
+
+    static constexpr unsigned nShards = 64 ;
+
+    struct Shard {
+      mutable std::mutex mutex{} ;
+      std::unordered_map< uint64_t, CellInfo > cells{} ;
+      std::atomic<uint64_t> hits{ 0 } ;
+      std::atomic<uint64_t> misses{ 0 } ;
+    } ;
+
+    CellInfo compute( uint64_t cellID ) const ;
+
+    std::string _name ;
+    const gear::GearMgr* _gear ;
+    Calculator _calc ;
+
+    mutable Shard _shards[ nShards ] ;
+
+    // dense table: state 0 empty, 1 being computed, 2 ready
+    DenseIndex _denseIndex ;
+    size_t _denseSize ;
+    mutable std::vector<CellInfo> _dense{} ;
+    std::unique_ptr< std::atomic<unsigned char>[] > _denseState{} ;
+    mutable std::atomic<uint64_t> _denseHits{ 0 } ;
+    mutable std::atomic<uint64_t> _denseMisses{ 0 } ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -0,0 +1,143 @@
+#ifndef CollectionView_h
+#define CollectionView_h 1
+
+#include "lcio.h"
+#include "EVENT/LCCollection.h"
+#include "IMPL/LCCollectionVec.h"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+namespace EVENT{
+  class MCParticle ; class ReconstructedParticle ; class CalorimeterHit ; class SimCalorimeterHit ;
+  class TrackerHit ; class SimTrackerHit ; class LCRelation ; class Track ; class Cluster ;
+  class Vertex ; class LCGenericObject ;
+}
+
+namespace marlin{
+
+  /** LCIO type names of the collections with elements of type T - specialized for the
+   *  LCIO event classes.
+   */
+  template <class T>
+  struct CollectionTypeName ;
+
+#define MARLIN_COLLECTION_TYPE_NAME( T, NAME )				\
+  template <> struct CollectionTypeName< EVENT::T > {			\
+    static bool matches( const std::string& type ) { return type == lcio::LCIO::NAME ; } \
+    static std::string name() { return lcio::LCIO::NAME ; }		\
+  } ;
+
+  MARLIN_COLLECTION_TYPE_NAME( MCParticle, MCPARTICLE )
+  MARLIN_COLLECTION_TYPE_NAME( ReconstructedParticle, RECONSTRUCTEDPARTICLE )
+  MARLIN_COLLECTION_TYPE_NAME( CalorimeterHit, CALORIMETERHIT )
+  MARLIN_COLLECTION_TYPE_NAME( SimCalorimeterHit, SIMCALORIMETERHIT )
+  MARLIN_COLLECTION_TYPE_NAME( SimTrackerHit, SIMTRACKERHIT )
+  MARLIN_COLLECTION_TYPE_NAME( LCRelation, LCRELATION )
+  MARLIN_COLLECTION_TYPE_NAME( Track, TRACK )
+  MARLIN_COLLECTION_TYPE_NAME( Cluster, CLUSTER )
+  MARLIN_COLLECTION_TYPE_NAME( Vertex, VERTEX )
+  MARLIN_COLLECTION_TYPE_NAME( LCGenericObject, LCGENERICOBJECT )
+
+#undef MARLIN_COLLECTION_TYPE_NAME
+
+  /** TrackerHitPlane and TrackerHitZCylinder are TrackerHits */
+  template <> struct CollectionTypeName< EVENT::TrackerHit > {
+    static bool matches( const std::string& type ) {
+      return type == lcio::LCIO::TRACKERHIT || type == lcio::LCIO::TRACKERHITPLANE || type == lcio::LCIO::TRACKERHITZCYLINDER ;
+    }
+    static std::string name() { return lcio::LCIO::TRACKERHIT ; }
+  } ;
+
+
+  /** Typed view of an LCIO collection: the type name of the collection is checked once
+   *  against T, the elements are then accessed with a static_cast instead of a
+   *  dynamic_cast per element. For an LCCollectionVec the elements are read directly from
+   *  its contiguous array, see objects(). The view always reflects the current content of
+   *  the collection - as for a std::vector, iterators are invalidated if elements are added
+   *  or removed.
+   *
+   *  <pre>
+   *    CollectionView<MCParticle> mcps( evt->getCollection( _inputCollectionName ) ) ;
+   *
+   *    for( MCParticle* mcp : mcps ) {
+   *      ...
+   *    }
+   *  </pre>
+   *
+   *  Throws an Exception if the collection does not hold elements of type T.
+   */
+  template <class T>
+  class CollectionView {
+
+  public:
+
+    class iterator {
+    public:
+      typedef std::random_access_iterator_tag iterator_category ;
+      typedef T* value_type ;
+      typedef std::ptrdiff_t difference_type ;
+      typedef T* const* pointer ;
+      typedef T* reference ;
+
+      iterator( const CollectionView* view, size_t i ) : _view( view ), _i( i ) {}
+
+      T* operator*() const { return (*_view)[ _i ] ; }
+      T* operator[]( difference_type n ) const { return (*_view)[ _i + n ] ; }
+
+      iterator& operator++() { ++_i ; return *this ; }
+      iterator operator++( int ) { iterator it( *this ) ; ++_i ; return it ; }
+      iterator& operator--() { --_i ; return *this ; }
+      iterator operator--( int ) { iterator it( *this ) ; --_i ; return it ; }
+      iterator& operator+=( difference_type n ) { _i += n ; return *this ; }
+      iterator& operator-=( difference_type n ) { _i -= n ; return *this ; }
+      iterator operator+( difference_type n ) const { return iterator( _view, _i + n ) ; }
+      iterator operator-( difference_type n ) const { return iterator( _view, _i - n ) ; }
+      difference_type operator-( const iterator& other ) const { return difference_type( _i ) - difference_type( other._i ) ; }
+
+      bool operator==( const iterator& other ) const { return _i == other._i ; }
+      bool operator!=( const iterator& other ) const { return _i != other._i ; }
+      bool operator<( const iterator& other ) const { return _i < other._i ; }
+
+    private:
+      const CollectionView* _view ;
+      size_t _i ;
+    } ;
+
+    explicit CollectionView( const EVENT::LCCollection* col ) : _col( col ) {
+
+      if( ! CollectionTypeName<T>::matches( col->getTypeName() ) )
+	throw lcio::Exception( "CollectionView: collection of type " + col->getTypeName()
+			       + " accessed as " + CollectionTypeName<T>::name() ) ;
+
+      _vec = dynamic_cast<const IMPL::LCCollectionVec*>( col ) ;
+    }
+
+    /** Number of elements */
+    size_t size() const { return _vec != 0 ? _vec->size() : size_t( _col->getNumberOfElements() ) ; }
+    bool empty() const { return size() == 0 ; }
+
+    /** Element i - no range check */
+    T* operator[]( size_t i ) const {
+      return static_cast<T*>( _vec != 0 ? (*_vec)[i] : _col->getElementAt( i ) ) ;
+    }
+
+    iterator begin() const { return iterator( this, 0 ) ; }
+    iterator end() const { return iterator( this, size() ) ; }
+
+    /** The contiguous array of the elements of an LCCollectionVec - NULL for other
+     *  implementations of LCCollection. Invalidated if elements are added to the collection.
+     */
+    EVENT::LCObject* const* objects() const { return _vec != 0 ? _vec->data() : 0 ; }
+
+    const EVENT::LCCollection* collection() const { return _col ; }
+
+  protected:
+
+    const EVENT::LCCollection* _col ;
+    const IMPL::LCCollectionVec* _vec = 0 ;
+  } ;
+
+} // end namespace marlin
+#endif
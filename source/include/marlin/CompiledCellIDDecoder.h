@@ -0,0 +1,89 @@
+#ifndef CompiledCellIDDecoder_h
+#define CompiledCellIDDecoder_h 1
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EVENT{ class LCCollection ; }
+
+namespace marlin{
+
+  /** Decoder for the cellIDs of one CellIDEncoding string, compiled into a table of shift
+   *  and mask extractors. Every distinct encoding is compiled once per job; the decoders
+   *  are immutable and shared by all processors and threads:
+   *
+   *  <pre>
+   *    auto decoder = CompiledCellIDDecoder::get( col ) ;   // encoding of the collection
+   *    const size_t layer = decoder->index( "layer" ) ;     // once, e.g. in the first event
+   *
+   *    int l = decoder->value( cellID, layer ) ;
+   *
+   *    std::vector<int> layers( hits->size() ) ;            // or a whole collection at once
+   *    decoder->decode( hits->cellID(), hits->size(), layer, layers.data() ) ;
+   *  </pre>
+   *
+   *  The cellIDs are 64 bit values cellID0 | cellID1 << 32, as in HitSoAView.
+   */
+  class CompiledCellIDDecoder {
+
+  public:
+
+    /** Extractor of one field */
+    struct Field {
+      std::string name{} ;
+      unsigned offset = 0 ;
+      unsigned width = 0 ;
+      bool isSigned = false ;
+      uint64_t mask = 0 ;
+
+      int64_t value( uint64_t cellID ) const {
+	const uint64_t v = ( cellID & mask ) >> offset ;
+	return ( isSigned ? int64_t( v << ( 64 - width ) ) >> ( 64 - width ) : int64_t( v ) ) ;
+      }
+    } ;
+
+    /** The decoder of the encoding string - compiled on the first request */
+    static std::shared_ptr<const CompiledCellIDDecoder> get( const std::string& encoding ) ;
+
+    /** The decoder of the CellIDEncoding parameter of the collection */
+    static std::shared_ptr<const CompiledCellIDDecoder> get( const EVENT::LCCollection* col ) ;
+
+    /** Compile the encoding string - throws an Exception if it is invalid */
+    explicit CompiledCellIDDecoder( const std::string& encoding ) ;
+
+    CompiledCellIDDecoder( const CompiledCellIDDecoder& ) = delete ;
+    CompiledCellIDDecoder& operator=( const CompiledCellIDDecoder& ) = delete ;
+
+    const std::string& encoding() const { return _encoding ; }
+
+    /** Number of fields */
+    size_t size() const { return _fields.size() ; }
+
+    const Field& operator[]( size_t i ) const { return _fields[i] ; }
+
+    /** Index of the field with the given name - throws an Exception if there is none */
+    size_t index( const std::string& name ) const ;
+
+    /** Value of field i of the cellID */
+    int64_t value( uint64_t cellID, size_t i ) const { return _fields[i].value( cellID ) ; }
+
+    /** Value of the named field of the cellID - prefer index() and value( cellID, i ) in loops */
+    int64_t value( uint64_t cellID, const std::string& name ) const { return _fields[ index( name ) ].value( cellID ) ; }
+
+    /** Values of field i of n cellIDs into out */
+    void decode( const uint64_t* cellIDs, size_t n, size_t i, int* out ) const ;
+
+    /** Values of all fields of n cellIDs - out[i] holds the n values of field i */
+    void decode( const uint64_t* cellIDs, size_t n, std::vector< std::vector<int> >& out ) const ;
+
+  protected:
+
+    std::string _encoding ;
+    std::vector<Field> _fields{} ;
+  } ;
+
+} // end namespace marlin
+#endif
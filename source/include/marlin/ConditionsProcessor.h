@@ -80,6 +80,10 @@ class ConditionsProcessor : public Processor {
 //   /** Called after data processing for clean up.
 //    */
   virtual void end() ;
+
+  /** Conditions are read per event - can run in worker processes.
+   */
+  virtual bool allowWorkerProcesses() const { return true ; }
   
   
  protected:
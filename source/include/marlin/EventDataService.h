@@ -0,0 +1,92 @@
+#ifndef EventDataService_h
+#define EventDataService_h 1
+
+#include "marlin/Exceptions.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+
+namespace EVENT{ class LCEvent ; }
+
+namespace marlin{
+
+  /** Service for data derived from the collections of an event, e.g. SoA views of hits,
+   *  spatial indices or relation navigators, that are built once and shared by all
+   *  processors (and threads) working on the event. The data is created by the given
+   *  factory on the first call to get() for the event - concurrent callers wait for it -
+   *  and all later calls in the same event return the same instance:
+   *
+   *  <pre>
+   *    auto view = context()->eventData()->get<HitSoAView>( evt, "HitSoAView:" + _colName,
+   *                                                         [&](){ return new HitSoAView( evt->getCollection( _colName ) ) ; } ) ;
+   *  </pre>
+   *
+   *  The data of an event is dropped by the ProcessorMgr after the event has been processed;
+   *  instances still referenced by processors stay valid. Processors that replace or modify
+   *  a collection the data was derived from have to invalidate() it.
+   *  The instance is held by Global::EVENTDATA.
+   */
+  class EventDataService {
+
+  public:
+
+    EventDataService() = default ;
+    EventDataService( const EventDataService& ) = delete ;
+    EventDataService& operator=( const EventDataService& ) = delete ;
+
+    /** Return the data with the given key for the event - created with factory() if it does
+     *  not exist. The factory has to return a T* (ownership is taken) or a std::shared_ptr<T>.
+     *  Throws an Exception if the data exists with a different type.
+     */
+    template <class T, class Factory>
+    std::shared_ptr<const T> get( const EVENT::LCEvent* evt, const std::string& key, Factory factory ) {
+
+      std::shared_ptr<Entry> e = entry( evt, key, typeid(T) ) ;
+
+      std::lock_guard<std::mutex> lock( e->mutex ) ;
+
+      if( ! e->data ) {
+	e->data = std::shared_ptr<const T>( factory() ) ;
+
+	if( ! e->data )
+	  throw Exception( std::string("EventDataService: factory returned no instance for ") + key ) ;
+      }
+      return std::static_pointer_cast<const T>( e->data ) ;
+    }
+
+    /** True if the data with the given key has been created for the event */
+    bool exists( const EVENT::LCEvent* evt, const std::string& key ) const ;
+
+    /** Drop the data with the given key of the event - the next get() creates it again */
+    void invalidate( const EVENT::LCEvent* evt, const std::string& key ) ;
+
+    /** Drop all data of the event - called by the ProcessorMgr after the event */
+    void endEvent( const EVENT::LCEvent* evt ) ;
+
+    /** Drop the data of all events */
+    void clear() ;
+
+  protected:
+
+    struct Entry {
+      explicit Entry( const std::type_info& t ) : type( t ) {}
+      std::type_index type ;
+      std::mutex mutex{} ;
+      std::shared_ptr<const void> data{} ;
+    } ;
+
+    typedef std::map< std::string, std::shared_ptr<Entry> > EntryMap ;
+
+    /** Return the entry for the given event and key - creates it if needed */
+    std::shared_ptr<Entry> entry( const EVENT::LCEvent* evt, const std::string& key, const std::type_info& type ) ;
+
+    mutable std::mutex _mutex{} ;
+    std::map< const EVENT::LCEvent*, EntryMap > _events{} ;
+  } ;
+
+} // end namespace marlin
+#endif
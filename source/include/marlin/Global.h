@@ -11,7 +11,9 @@
 
 namespace marlin{
 
+  class EventDataService ;
   class ProcessorEventSeeder;
+  class ResourceService ;
   class StringParameters ;
 
   /** Simple global class for Marlin.
@@ -33,6 +35,10 @@ namespace marlin{
 
     static ProcessorEventSeeder* EVENTSEEDER ;
 
+    static ResourceService* RESOURCES ;
+
+    static EventDataService* EVENTDATA ;
+
 
   };
   
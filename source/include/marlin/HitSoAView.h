@@ -0,0 +1,96 @@
+#ifndef HitSoAView_h
+#define HitSoAView_h 1
+
+#include "lcio.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EVENT{
+  class LCCollection ;
+  class LCEvent ;
+  class LCObject ;
+}
+
+namespace marlin{
+
+  /** Structure-of-arrays view of a CalorimeterHit or TrackerHit collection: aligned
+   *  arrays of the x, y, z position, the energy (deposit), the time and the 64 bit cellID
+   *  (cellID0 | cellID1 << 32) of the hits, and the LCIO object of every hit.
+   *
+   *  The view of a collection is built once per event on the first request and shared
+   *  by all processors through the EventDataService:
+   *
+   *  <pre>
+   *    std::shared_ptr<const HitSoAView> hits = HitSoAView::get( evt, _colName ) ;
+   *
+   *    const float* x = hits->x() ;
+   *    const float* e = hits->energy() ;
+   *    for( size_t i=0 ; i < hits->size() ; ++i )
+   *      sum += e[i] * x[i] ;
+   *  </pre>
+   */
+  class HitSoAView {
+
+  public:
+
+    /** Alignment of the arrays in bytes */
+    static constexpr size_t alignment = 64 ;
+
+    /** The view of the named collection in the event - built on the first request in the
+     *  event. Throws DataNotAvailableException if the collection does not exist and an
+     *  Exception if it is not a hit collection.
+     */
+    static std::shared_ptr<const HitSoAView> get( EVENT::LCEvent* evt, const std::string& colName ) ;
+
+    /** Build the view of a CalorimeterHit, TrackerHit, TrackerHitPlane or TrackerHitZCylinder
+     *  collection.
+     */
+    explicit HitSoAView( const EVENT::LCCollection* col ) ;
+
+    HitSoAView( const HitSoAView& ) = delete ;
+    HitSoAView& operator=( const HitSoAView& ) = delete ;
+
+    /** Number of hits */
+    size_t size() const { return _size ; }
+
+    /** True for calorimeter hits, false for tracker hits */
+    bool isCalorimeterHit() const { return _calorimeterHits ; }
+
+    const float* x() const { return _floats.get() ; }
+    const float* y() const { return _floats.get() + _stride ; }
+    const float* z() const { return _floats.get() + 2 * _stride ; }
+
+    /** Energy of calorimeter hits, EDep of tracker hits */
+    const float* energy() const { return _floats.get() + 3 * _stride ; }
+
+    const float* time() const { return _floats.get() + 4 * _stride ; }
+
+    const uint64_t* cellID() const { return _cellIDs.data() ; }
+
+    /** The LCIO object of hit i */
+    EVENT::LCObject* object( size_t i ) const { return _objects[i] ; }
+
+    /** The hit i as CalorimeterHit or TrackerHit - no type check */
+    template <class T>
+    T* hit( size_t i ) const { return static_cast<T*>( _objects[i] ) ; }
+
+  protected:
+
+    struct AlignedDelete {
+      void operator()( float* p ) const ;
+    } ;
+
+    size_t _size = 0 ;
+    size_t _stride = 0 ;  // size padded to a multiple of the alignment
+    bool _calorimeterHits = false ;
+    std::unique_ptr< float[], AlignedDelete > _floats{} ;
+    std::vector<uint64_t> _cellIDs{} ;
+    std::vector<EVENT::LCObject*> _objects{} ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -7,6 +7,10 @@
 
 #include "CLHEP/Vector/LorentzVector.h"
 
+#include "marlin/PhiloxRandom.h"
+
+#include <cstddef>
+
 namespace CLHEP{}    // declare namespace CLHEP for backward compatibility
 using namespace CLHEP ;
 
@@ -14,6 +18,21 @@ using namespace CLHEP ;
 namespace marlin{
 
 
+  /** Four vectors in structure-of-arrays layout for smearing in batches -
+   *  the arrays are owned by the caller. If random is set, the smearers draw their
+   *  random numbers from this stream instead of the global CLHEP engine.
+   */
+  struct FourVectorArrays {
+    size_t size = 0 ;
+    double* px = 0 ;
+    double* py = 0 ;
+    double* pz = 0 ;
+    double* e = 0 ;
+    const int* pdg = 0 ;
+    RandomStream* random = 0 ;
+  } ;
+
+
   /** Interface for smearing of four vectors - based on CLHEP::HepLorentzVector
    *
    *  @author F. Gaede, DESY
@@ -30,6 +49,29 @@ namespace marlin{
     /** Smears the given four vector 
      */ 
     virtual HepLorentzVector smearedFourVector( const HepLorentzVector& v, int pdgCode ) = 0 ;
+
+    /** Smears all four vectors of the arrays in place - the default calls smearedFourVector()
+     *  for every vector and ignores v.random, implementations can override this with a
+     *  vectorized version.
+     */
+    virtual void smearFourVectors( FourVectorArrays& v ) {
+
+      for( size_t i=0 ; i < v.size ; ++i ) {
+
+	HepLorentzVector sv = smearedFourVector( HepLorentzVector( v.px[i], v.py[i], v.pz[i], v.e[i] ), v.pdg[i] ) ;
+
+	v.px[i] = sv.px() ;
+	v.py[i] = sv.py() ;
+	v.pz[i] = sv.pz() ;
+	v.e[i] = sv.e() ;
+      }
+    }
+
+    /** True if smearFourVectors() draws all its random numbers from v.random, if set, and
+     *  does not modify the smearer - i.e. calls with different streams may run concurrently.
+     *  False for the default, which uses the global CLHEP engine.
+     */
+    virtual bool usesRandomStream() const { return false ; }
     
   } ;
   
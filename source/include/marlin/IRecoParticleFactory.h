@@ -5,10 +5,26 @@
 #include "EVENT/MCParticle.h"
 #include "EVENT/ReconstructedParticle.h"
 
+#include "marlin/PhiloxRandom.h"
+
+#include <cstddef>
+#include <vector>
+
 
 namespace marlin{
 
 
+  /** Smeared four vectors of a batch of particles in input order - type[i] is the
+   *  FastMCParticleType of particle i or -1 if no ReconstructedParticle is created for it.
+   */
+  struct SmearedParticles {
+    std::vector<int> type{} ;
+    std::vector<double> px{} ;
+    std::vector<double> py{} ;
+    std::vector<double> pz{} ;
+    std::vector<double> e{} ;
+  } ;
+
   /** Interface for a factory class that creates a ReconstructedParticle
    *  from an MCParticle 
    *
@@ -28,6 +44,41 @@ namespace marlin{
      *  due to detector acceptance.
      */ 
     virtual lcio::ReconstructedParticle* createReconstructedParticle( const lcio::MCParticle* mcp ) = 0 ;
+
+    /** Creates the ReconstructedParticles for n MCParticles in one batch: recs[i] is the particle
+     *  for mcps[i] or NULL. Implementations use the random stream, if given, instead of a global
+     *  random engine. The default calls createReconstructedParticle() for every particle.
+     *  Not thread safe: the ReconstructedParticles are created in the call.
+     */
+    virtual void createReconstructedParticles( const lcio::MCParticle* const* mcps, size_t n,
+					       lcio::ReconstructedParticle** recs,
+					       RandomStream* /*random*/ = 0 ) {
+      for( size_t i=0 ; i < n ; ++i )
+	recs[i] = createReconstructedParticle( mcps[i] ) ;
+    }
+
+    /** True if smearParticles() is implemented, draws all random numbers from the given stream
+     *  and does not modify the factory - i.e. calls with different streams may run concurrently.
+     *  False for the default.
+     */
+    virtual bool supportsConcurrentSmearing() const { return false ; }
+
+    /** First step of createReconstructedParticles(): smears the four vectors of n MCParticles
+     *  into s without creating any LCIO object. Only called if supportsConcurrentSmearing().
+     */
+    virtual void smearParticles( const lcio::MCParticle* const* /*mcps*/, size_t /*n*/,
+				 SmearedParticles& /*s*/, RandomStream* /*random*/ ) {
+      throw lcio::Exception( "IRecoParticleFactory::smearParticles() not implemented" ) ;
+    }
+
+    /** Second step of createReconstructedParticles(): creates the ReconstructedParticles for the
+     *  four vectors smeared by smearParticles() - recs[i] is the particle for mcps[i] or NULL.
+     *  Has to be called on one thread at a time.
+     */
+    virtual void createParticles( const lcio::MCParticle* const* /*mcps*/, size_t /*n*/,
+				  const SmearedParticles& /*s*/, lcio::ReconstructedParticle** /*recs*/ ) {
+      throw lcio::Exception( "IRecoParticleFactory::createParticles() not implemented" ) ;
+    }
     
   } ;
   
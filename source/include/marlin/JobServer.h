@@ -0,0 +1,66 @@
+#ifndef JobServer_h
+#define JobServer_h 1
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace marlin{
+
+  /** Server for Marlin jobs on a local Unix socket ( Marlin --server <socket> ).
+   *  The server process loads the processor libraries (and optionally geometries) once;
+   *  every job request - the working directory and the Marlin command line, i.e. the
+   *  steering file with dynamic command line options - is run in a fork of the server
+   *  process, so the loaded libraries are shared copy-on-write and the jobs are isolated
+   *  from each other and from the server.
+   *
+   *  The stdout and stderr of the job are streamed back to the client, followed by the
+   *  exit code of the job.
+   *
+   *  A job can be submitted with submit() ( Marlin --client <socket> ... ).
+   *
+   *  The jobs run with the rights of the server: the socket is created with mode 0600 and
+   *  connections of processes of other users are rejected. The socket of a server that is
+   *  still running is not replaced.
+   */
+  class JobServer {
+
+  public:
+
+    /** The function that runs a job with the given command line (including argv[0])
+     *  and returns the exit code - called in the forked job process.
+     */
+    typedef std::function< int( std::vector<std::string>& ) > JobFunction ;
+
+    JobServer( const std::string& socketName, JobFunction job ) ;
+    ~JobServer() ;
+
+    JobServer( const JobServer& ) = delete ;
+    JobServer& operator=( const JobServer& ) = delete ;
+
+    /** Accept and run jobs - does not return unless an error occurs. Throws if another
+     *  server accepts connections on the socket.
+     */
+    void run() ;
+
+    /** Submit a job with the given command line to the server on socketName, run in the
+     *  working directory cwd. Writes the output of the job to stdout and returns its exit
+     *  code.
+     */
+    static int submit( const std::string& socketName, const std::vector<std::string>& args,
+		       const std::string& cwd ) ;
+
+  protected:
+
+    /** Read the request from the connection, run the job in a forked process and stream
+     *  its output back - called in a forked process for every connection.
+     */
+    void handleConnection( int fd ) ;
+
+    std::string _socketName ;
+    JobFunction _job ;
+    int _fd = -1 ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -5,6 +5,9 @@
 #include "lcio.h"
 #include "IO/LCWriter.h"
 
+#include <memory>
+#include <ostream>
+
 
 using namespace lcio ;
 
@@ -80,6 +83,22 @@ namespace marlin{
      */
     virtual void end() ;
 
+    /** Worker processes write their events to separate files which are merged in the
+     *  main process.
+     */
+    virtual bool allowWorkerProcesses() const { return true ; }
+
+    /** Write the events of the worker process to its own file and the input positions of
+     *  the records to an index file (multi-process mode).
+     */
+    virtual void workerStarted( int workerID ) ;
+
+    /** Copy the run headers and events of all worker files to the output file in the order
+     *  of the input and remove the worker files (multi-process mode). The position in the
+     *  input of every record is read from the index file written by the worker.
+     */
+    virtual void mergeWorkerOutput( int nWorkers ) ;
+
     /** Drops the collections specified in the steering file parameters DropCollectionNames and 
      *  DropCollectionTypes. 
      */
@@ -105,6 +124,15 @@ namespace marlin{
     int _nEvt=-1;
     int _compressionLevel{6};
 
+    /** Name of the output file of the given worker process */
+    std::string workerFileName( int workerID ) const ;
+
+    /** Name of the index file of the given worker process */
+    std::string workerIndexFileName( int workerID ) const ;
+
+    /** Input positions of the records written by a worker process */
+    std::unique_ptr<std::ostream> _workerIndex{} ;
+
   private:
   
     /** Inititalization for constructors */
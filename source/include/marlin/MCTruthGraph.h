@@ -0,0 +1,141 @@
+#ifndef MCTruthGraph_h
+#define MCTruthGraph_h 1
+
+#include "lcio.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EVENT{
+  class LCCollection ;
+  class LCEvent ;
+  class MCParticle ;
+}
+
+namespace marlin{
+
+  /** Flattened parent/daughter graph of an MCParticle collection: particles are referred
+   *  to by their index in the collection, parents and daughters are stored in compressed
+   *  sparse row arrays. The graph has a topological order (parents before daughters), the
+   *  generation depth of every particle (0 for particles without parents) and, for events
+   *  with up to maxAncestorBits particles, a bitset of the ancestors of every particle.
+   *
+   *  The graph of a collection is built once per event on the first request and shared by
+   *  all processors through the EventDataService:
+   *
+   *  <pre>
+   *    auto graph = MCTruthGraph::get( evt, _mcParticleCollectionName ) ;
+   *
+   *    unsigned i = graph->index( mcp ) ;
+   *    std::vector<unsigned> stable ;
+   *    graph->stableDescendants( graph->primary( i ), stable ) ;
+   *    for( unsigned d : graph->daughters( i ) ) ...
+   *  </pre>
+   */
+  class MCTruthGraph {
+
+  public:
+
+    /** Index of particles not in the collection */
+    static constexpr unsigned npos = unsigned( -1 ) ;
+
+    /** Largest number of particles for which the ancestor bitsets are stored (N^2 bits) */
+    static constexpr size_t maxAncestorBits = 8192 ;
+
+    /** Indices of the parents or daughters of a particle */
+    class IndexRange {
+    public:
+      IndexRange( const unsigned* first, const unsigned* last ) : _first( first ), _last( last ) {}
+
+      const unsigned* begin() const { return _first ; }
+      const unsigned* end() const { return _last ; }
+      size_t size() const { return _last - _first ; }
+      bool empty() const { return _first == _last ; }
+      unsigned operator[]( size_t i ) const { return _first[i] ; }
+
+    private:
+      const unsigned* _first ;
+      const unsigned* _last ;
+    } ;
+
+    /** The graph of the named MCParticle collection in the event - built on the first request
+     *  in the event.
+     */
+    static std::shared_ptr<const MCTruthGraph> get( EVENT::LCEvent* evt, const std::string& colName ) ;
+
+    /** Build the graph of an MCParticle collection */
+    explicit MCTruthGraph( const EVENT::LCCollection* col ) ;
+
+    MCTruthGraph( const MCTruthGraph& ) = delete ;
+    MCTruthGraph& operator=( const MCTruthGraph& ) = delete ;
+
+    /** Number of particles */
+    size_t size() const { return _particles.size() ; }
+
+    EVENT::MCParticle* particle( unsigned i ) const { return _particles[i] ; }
+
+    /** Index of the particle in the collection - npos if it is not in the collection */
+    unsigned index( const EVENT::MCParticle* mcp ) const ;
+
+    IndexRange parents( unsigned i ) const {
+      return IndexRange( _parents.data() + _parentStart[i], _parents.data() + _parentStart[ i + 1 ] ) ;
+    }
+
+    IndexRange daughters( unsigned i ) const {
+      return IndexRange( _daughters.data() + _daughterStart[i], _daughters.data() + _daughterStart[ i + 1 ] ) ;
+    }
+
+    int pdg( unsigned i ) const { return _pdg[i] ; }
+    int generatorStatus( unsigned i ) const { return _generatorStatus[i] ; }
+
+    /** Number of generations above the particle - 0 for particles without parents */
+    unsigned depth( unsigned i ) const { return _depth[i] ; }
+
+    /** All particles, parents before their daughters */
+    const std::vector<unsigned>& topologicalOrder() const { return _order ; }
+
+    /** True if the ancestor bitsets are stored - otherwise isAncestor() walks the parents */
+    bool hasAncestorBits() const { return ! _ancestorBits.empty() ; }
+
+    /** True if a is an ancestor of d */
+    bool isAncestor( unsigned a, unsigned d ) const ;
+
+    /** Append the indices of all ancestors of i to result */
+    void ancestors( unsigned i, std::vector<unsigned>& result ) const ;
+
+    /** Append the indices of all descendants of i with generator status 1 to result */
+    void stableDescendants( unsigned i, std::vector<unsigned>& result ) const ;
+
+    /** The ancestor of i without parents found following the first parents - i itself if
+     *  it has no parents.
+     */
+    unsigned primary( unsigned i ) const ;
+
+  protected:
+
+    std::vector<EVENT::MCParticle*> _particles{} ;
+    std::vector<int> _pdg{} ;
+    std::vector<int> _generatorStatus{} ;
+
+    // CSR adjacency
+    std::vector<unsigned> _parentStart{} ;
+    std::vector<unsigned> _parents{} ;
+    std::vector<unsigned> _daughterStart{} ;
+    std::vector<unsigned> _daughters{} ;
+
+    std::vector<unsigned> _order{} ;
+    std::vector<unsigned> _depth{} ;
+
+    // particle pointers sorted for index()
+    std::vector< std::pair<const EVENT::MCParticle*, unsigned> > _lookup{} ;
+
+    // _words bits per particle
+    size_t _words = 0 ;
+    std::vector<uint64_t> _ancestorBits{} ;
+  } ;
+
+} // end namespace marlin
+#endif
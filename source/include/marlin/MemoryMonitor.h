@@ -46,6 +46,9 @@ public:
 	
 	// Called at the very end for cleanup, histogram saving, etc.
 	virtual void end() ;
+
+	// Every worker process monitors its own memory.
+	virtual bool allowWorkerProcesses() const { return true ; }
 	
 	
 protected:
@@ -0,0 +1,109 @@
+#ifndef MultiProcessRunner_h
+#define MultiProcessRunner_h 1
+
+#include "lcio.h"
+
+#include "IO/LCRunListener.h"
+#include "IO/LCEventListener.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+using namespace lcio ;
+
+namespace marlin{
+
+  class ProcessorMgr ;
+
+  /** Multi-process mode of Marlin (global parameter NumberOfProcesses): after init() of all
+   *  processors the process is forked into N worker processes that share the initialized
+   *  processors, libraries and geometry copy-on-write.
+   *
+   *  Every worker reads the input and is registered as run and event listener with its
+   *  LCReader. The events are divided into chunks of EventChunkSize consecutive events;
+   *  a chunk is processed by the first worker that reaches it, the other workers skip it.
+   *  Thus busy workers fall behind and leave the following chunks to the others.
+   *  All run headers are passed to the processors of every worker. Note that every worker
+   *  reads and decodes the complete input - the mode pays off if the processing time per
+   *  event is large compared to the reading time.
+   *
+   *  The ProcessorMgr::inputEventIndex() is set to the position in the input before every
+   *  event and run header, so that the output of the workers can be merged in input order
+   *  (see LCIOOutputProcessor). A StopProcessingException in one worker stops all workers
+   *  before their next event or run header; events of chunks that other workers have
+   *  already started are still processed.
+   *
+   *  At the end the workers call ProcessorMgr::end() and write their skip and timing
+   *  statistics, that are combined in the main process in ProcessorMgr::endWorkers().
+   *  The statistics files are written to a directory created with mkdtemp() in $TMPDIR
+   *  (default /tmp) before the fork, that is removed in wait().
+   */
+  class MultiProcessRunner : public LCRunListener, public LCEventListener {
+
+  public:
+
+    MultiProcessRunner( int nProcesses, int chunkSize, ProcessorMgr* procMgr ) ;
+    virtual ~MultiProcessRunner() ;
+
+    MultiProcessRunner( const MultiProcessRunner& ) = delete ;
+    MultiProcessRunner& operator=( const MultiProcessRunner& ) = delete ;
+
+    /** Fork the worker processes - returns the ID of the worker (0...N-1) in the worker
+     *  processes and -1 in the main process.
+     */
+    int start() ;
+
+    /** Worker process: write the statistics for the main process - call before
+     *  ProcessorMgr::end().
+     */
+    void finishWorker() ;
+
+    /** Main process: wait for all workers and add their statistics to the ProcessorMgr -
+     *  false if a worker failed.
+     */
+    bool wait() ;
+
+    /** ID of this worker process, -1 in the main process */
+    int workerID() const { return _workerID ; }
+
+    int numberOfProcesses() const { return _nProcesses ; }
+
+    virtual void processRunHeader( LCRunHeader* run ) ;
+    virtual void modifyRunHeader( LCRunHeader* run ) ;
+    virtual void processEvent( LCEvent* evt ) ;
+    virtual void modifyEvent( LCEvent* evt ) ;
+
+  protected:
+
+    /** True if the current event is in a chunk claimed by this worker */
+    bool acceptEvent() ;
+
+    /** Throws a StopProcessingException if another worker stopped the processing */
+    void checkStop() ;
+
+    /** Name of the file with the statistics of the given worker */
+    std::string statisticsFile( int workerID ) const ;
+
+    int _nProcesses ;
+    long _chunkSize ;
+    ProcessorMgr* _procMgr ;
+    /** Private directory for the statistics files of the workers - created in start() */
+    std::string _statsDir{} ;
+    int _workerID = -1 ;
+    std::vector<pid_t> _workers{} ;
+
+    // one flag per chunk in memory shared by all workers
+    std::atomic<unsigned char>* _claimed = nullptr ;
+    std::atomic<unsigned char>* _stop = nullptr ;
+    long _maxChunks ;
+
+    long _index = 0 ;
+    long _currentChunk = -1 ;
+    bool _chunkAccepted = false ;
+  } ;
+
+} // end namespace marlin
+#endif
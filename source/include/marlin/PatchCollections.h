@@ -70,6 +70,10 @@ namespace marlin {
      */
     virtual void end() ;
 
+    /** Patches every event on its own - can run in worker processes.
+     */
+    virtual bool allowWorkerProcesses() const { return true ; }
+
     virtual const std::string & name() const { return Processor::name() ; }
 
 
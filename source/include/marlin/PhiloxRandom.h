@@ -0,0 +1,108 @@
+#ifndef PhiloxRandom_h
+#define PhiloxRandom_h 1
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace marlin{
+
+  /** Stateless counter based random number generator Philox4x32-10 as described in
+   *  J.K. Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11.
+   *  The output is a pure function of the 128 bit counter and the 64 bit key, i.e.
+   *  random numbers for a given (key,counter) can be computed in O(1) in any order and
+   *  on any thread.
+   */
+  class Philox4x32 {
+
+  public:
+
+    typedef std::array<uint32_t,4> Counter ;
+    typedef std::array<uint32_t,2> Key ;
+
+    /** Return the four 32 bit random numbers for the given counter and key. */
+    static Counter generate( Counter ctr, Key key ) {
+
+      ctr = round( ctr, key ) ;
+
+      for( unsigned i=1 ; i < 10 ; ++i ){
+	key[0] += 0x9E3779B9 ;
+	key[1] += 0xBB67AE85 ;
+	ctr = round( ctr, key ) ;
+      }
+      return ctr ;
+    }
+
+  private:
+
+    static Counter round( const Counter& ctr, const Key& key ) {
+
+      const uint64_t p0 = uint64_t( 0xD2511F53 ) * ctr[0] ;
+      const uint64_t p1 = uint64_t( 0xCD9E8D57 ) * ctr[2] ;
+
+      return {{ uint32_t( p1 >> 32 ) ^ ctr[1] ^ key[0] , uint32_t( p1 ) ,
+	        uint32_t( p0 >> 32 ) ^ ctr[3] ^ key[1] , uint32_t( p0 ) }} ;
+    }
+  } ;
+
+
+  /** Independent stream of pseudo-random numbers based on Philox4x32.
+   *  A stream is fully defined by its key and the first three words of the counter,
+   *  the last counter word enumerates the blocks of four numbers within the stream.
+   *  Streams are cheap value objects that can be copied to other threads, and
+   *  substream(i) returns a new independent stream, e.g. for a chunk of work within an event.
+   *  Fulfills the requirements of a UniformRandomBitGenerator, so it can be used with
+   *  the distributions from &lt;random&gt;.
+   */
+  class RandomStream {
+
+  public:
+
+    typedef uint32_t result_type ;
+
+    RandomStream() = default ;
+
+    RandomStream( const Philox4x32::Key& key, const Philox4x32::Counter& ctr ) :
+      _key( key ), _ctr( ctr ) {
+      _ctr[3] = 0 ;
+    }
+
+    static constexpr result_type min() { return 0 ; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max() ; }
+
+    /** Next 32 bit random number of this stream. */
+    result_type operator()() {
+
+      if( _pos == 4 ){
+	_block = Philox4x32::generate( _ctr, _key ) ;
+	++_ctr[3] ;
+	_pos = 0 ;
+      }
+      return _block[ _pos++ ] ;
+    }
+
+    /** Uniformly distributed double in the open interval (0,1). */
+    double uniform() {
+      const uint64_t r = ( uint64_t( (*this)() ) << 21 ) ^ ( (*this)() >> 11 ) ;  // 53 bits
+      return ( double( r ) + 0.5 ) * ( 1.0 / 9007199254740992.0 ) ;
+    }
+
+    /** An independent stream derived from this one, e.g. for the i-th chunk of an event.
+     *  The result does not depend on how many numbers have been drawn from this stream.
+     */
+    RandomStream substream( uint32_t index ) const {
+
+      Philox4x32::Counter ctr = _ctr ;
+      ctr[2] = ( ctr[2] * 0x9E3779B9 ) ^ ( index + 1 ) ;
+      return RandomStream( _key, ctr ) ;
+    }
+
+  private:
+    Philox4x32::Key _key{{0,0}} ;
+    Philox4x32::Counter _ctr{{0,0,0,0}} ;
+    Philox4x32::Counter _block{{0,0,0,0}} ;
+    unsigned _pos = 4 ;
+  } ;
+
+} // end namespace marlin
+#endif
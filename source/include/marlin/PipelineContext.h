@@ -0,0 +1,133 @@
+#ifndef PipelineContext_h
+#define PipelineContext_h 1
+
+#include <memory>
+
+namespace gear{ class GearMgr ; }
+
+namespace marlin{
+
+  class EventDataService ;
+  class ProcessorMgr ;
+  class ProcessorEventSeeder ;
+  class ResourceService ;
+  class StringParameters ;
+
+  /** Context of one processing pipeline: owns the global steering parameters, the geometry,
+   *  the ProcessorEventSeeder, the ResourceService, the EventDataService and the ProcessorMgr with the list of
+   *  active processors and their conditions.
+   *
+   *  The default context is the Marlin application itself: its members are the Global
+   *  variables and ProcessorMgr::instance(). Additional independent pipelines can be created
+   *  in the same process, e.g. by an embedding framework:
+   *
+   *  <pre>
+   *    PipelineContext ctx ;
+   *    ctx.setParameters( parser.getParameters("Global") ) ;
+   *    ctx.setGear( gearMgr ) ;
+   *    ctx.processorMgr()->addActiveProcessor( type, name, parameters ) ;
+   *    ctx.processorMgr()->init() ;
+   *    lcReader->registerLCEventListener( ctx.processorMgr() ) ; // several pipelines can share one reader
+   *    ...
+   *    ctx.processorMgr()->end() ;
+   *  </pre>
+   *
+   *  Processor types (prototypes) are registered process wide, i.e. the loaded libraries are
+   *  shared by all pipelines. While a ProcessorMgr calls its processors, its context is the
+   *  current() context of the thread, so ProcessorMgr::instance() returns the calling
+   *  pipeline's manager. Processors should use Processor::context() instead of the Global
+   *  variables, which always refer to the default context.
+   */
+  class PipelineContext {
+
+    friend class ProcessorMgr ;
+
+  public:
+
+    /** The default context of the Marlin application.
+     */
+    static PipelineContext* defaultContext() ;
+
+    /** The context of the pipeline processed in the current thread: the context set by the
+     *  innermost active PipelineContext::Scope or the default context.
+     */
+    static PipelineContext* current() ;
+
+    /** Create a new independent pipeline with its own ProcessorMgr.
+     */
+    PipelineContext() ;
+
+    /** Deletes the ProcessorMgr, seeder, resources and geometry of a non-default context.
+     *  ProcessorMgr::end() has to be called before.
+     */
+    ~PipelineContext() ;
+
+    PipelineContext( const PipelineContext& ) = delete ;
+    PipelineContext& operator=( const PipelineContext& ) = delete ;
+
+    /** True for the context of the Marlin application */
+    bool isDefault() const { return _isDefault ; }
+
+    /** The global steering parameters of the pipeline */
+    StringParameters* parameters() const { return _parameters ; }
+
+    /** Set the global steering parameters - kept alive by the context */
+    void setParameters( std::shared_ptr<StringParameters> parameters ) ;
+
+    /** The geometry of the pipeline */
+    gear::GearMgr* GEAR() const { return _gear ; }
+
+    /** Set the geometry - the context takes ownership, except for the default context */
+    void setGear( gear::GearMgr* gearMgr ) ;
+
+    /** The random seed service of the pipeline (NULL after ProcessorMgr::end()) */
+    ProcessorEventSeeder* eventSeeder() const { return _seeder ; }
+
+    /** The shared resources of the pipeline (NULL after ProcessorMgr::end()) */
+    ResourceService* resources() const { return _resources ; }
+
+    /** The data shared by the processors for the current event (NULL after ProcessorMgr::end()) */
+    EventDataService* eventData() const { return _eventData ; }
+
+    /** The processor manager of the pipeline */
+    ProcessorMgr* processorMgr() ;
+
+    /** Makes the given context the current() context of this thread for the lifetime of the scope.
+     */
+    class Scope {
+    public:
+      explicit Scope( PipelineContext* ctx ) ;
+      ~Scope() ;
+      Scope( const Scope& ) = delete ;
+      Scope& operator=( const Scope& ) = delete ;
+    private:
+      PipelineContext* _previous ;
+    } ;
+
+  private:
+
+    /** c'tor for the default context */
+    explicit PipelineContext( bool isDefault ) ;
+
+    bool _isDefault ;
+
+    // own pointers of a non-default context
+    StringParameters* _ownParameters = nullptr ;
+    gear::GearMgr* _ownGear = nullptr ;
+    ProcessorEventSeeder* _ownSeeder = nullptr ;
+    ResourceService* _ownResources = nullptr ;
+    EventDataService* _ownEventData = nullptr ;
+
+    // refer to the Global variables for the default context
+    StringParameters*& _parameters ;
+    gear::GearMgr*& _gear ;
+    ProcessorEventSeeder*& _seeder ;
+    ResourceService*& _resources ;
+    EventDataService*& _eventData ;
+
+    std::shared_ptr<StringParameters> _parameterHolder{} ;
+    ProcessorMgr* _mgr = nullptr ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -0,0 +1,61 @@
+#ifndef PolarAngleBinning_h
+#define PolarAngleBinning_h 1
+
+#include <utility>
+#include <vector>
+
+namespace marlin{
+
+  /** Direct index lookup of the resolution for a polar angle. The ranges (thMin,thMax] are
+   *  given in order of priority, i.e. index() returns the same as a linear search for the
+   *  first range containing theta. The ranges are split into segments at their boundaries
+   *  and a uniform table of bins points to the first segment of every bin, so that the
+   *  lookup needs on average one table access and one comparison - independent of the
+   *  number of ranges, e.g. for finely binned resolution maps:
+   *
+   *  <pre>
+   *    _bins.init( ranges ) ;                  // once, in the constructor
+   *
+   *    int i = _bins.index( theta ) ;          // per particle, -1 if no range contains theta
+   *  </pre>
+   */
+  class PolarAngleBinning {
+
+  public:
+
+    PolarAngleBinning() = default ;
+
+    /** Build the tables for the ranges (thMin,thMax] - empty ranges are ignored */
+    void init( const std::vector< std::pair<double,double> >& ranges ) ;
+
+    /** Index of the first range containing theta - -1 if there is none */
+    int index( double theta ) const {
+
+      if( ! ( theta > _lower && theta <= _upper ) )
+	return -1 ;
+
+      unsigned bin = unsigned( ( theta - _lower ) * _invWidth ) ;
+      if( bin >= _first.size() )
+	bin = _first.size() - 1 ;
+
+      unsigned seg = _first[ bin ] ;
+
+      while( theta > _edges[ seg + 1 ] ) ++seg ;
+      while( seg > 0 && theta <= _edges[ seg ] ) --seg ;
+
+      return _index[ seg ] ;
+    }
+
+  protected:
+
+    double _lower = 0. ;
+    double _upper = -1. ;
+    double _invWidth = 0. ;
+
+    std::vector<double> _edges{} ;     // segment s is (_edges[s],_edges[s+1]]
+    std::vector<int> _index{} ;        // range index of every segment
+    std::vector<unsigned> _first{} ;   // first segment of every bin
+  } ;
+
+} // end namespace marlin
+#endif
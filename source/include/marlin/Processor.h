@@ -50,6 +50,7 @@ struct ExternalProcessorMgrAccessor {
 };
 
   class ProcessorMgr ;
+  class PipelineContext ;
   //  class ProcessorParameter ;
   class XMLFixCollTypes ;
 
@@ -88,6 +89,20 @@ struct ExternalProcessorMgrAccessor {
 
   public:
 
+    /** Level of concurrency supported by a processor - declared in the constructor
+     *  with setConcurrency(). Marlin itself processes events sequentially, the level is
+     *  printed in the steering file templates and tells applications that process events
+     *  concurrently whether the processor can be cloned (see clone()) or shared.
+     */
+    enum Concurrency {
+      SERIAL_ONLY = 0 ,       // processEvent() must never be called concurrently (default)
+      CLONE_PER_THREAD = 1 ,  // independent clones can process events concurrently 
+      REENTRANT_SHARED = 2    // one instance can process several events concurrently
+    } ;
+
+    /** Human readable name of the concurrency level, e.g. "SerialOnly" */
+    static const char* concurrencyName( Concurrency c ) ;
+
 // 	/** Possible verbosity levels */
 //     enum{ VERBOSE = 0, DEBUG = 0, MESSAGE = 1, WARNING = 2, ERROR = 3, SILENT = 4 };
  
@@ -107,6 +122,35 @@ struct ExternalProcessorMgrAccessor {
      * Has to be implemented by subclasses.
      */
     virtual Processor*  newProcessor() = 0 ;
+
+    /** Return a fully configured copy of this processor: the copy is created with newProcessor(),
+     *  shares the StringParameters and the values of all registered parameters are copied 
+     *  from the already parsed ProcParamMap, i.e. the steering parameters are not parsed again.
+     *  init() is not called for the copy.
+     */
+    virtual Processor* clone() ;
+
+    /** The level of concurrency this processor supports (as set with setConcurrency()).
+     */
+    virtual Concurrency concurrency() const { return _concurrency ; }
+
+    /** True if init() and end() of this processor do not depend on other processors and can be
+     *  called concurrently with those of other independent processors (as set with 
+     *  setIndependentInit()) - used if the global parameter ParallelInit is true.
+     */
+    virtual bool independentInit() const { return _independentInit ; }
+
+    /** True if processEvent() is not to be called for events in which all input collections of
+     *  the processor are missing or empty (as set with setSkipWithoutInputs()) - the global
+     *  parameter SkipWithoutInputs=true applies this to all processors with input collections.
+     */
+    virtual bool skipWithoutInputs() const { return _skipWithoutInputs ; }
+
+    /** The context of the pipeline this processor belongs to - use its parameters(), GEAR(),
+     *  eventSeeder(), resources() and eventData() instead of the Global variables to support several
+     *  pipelines in one process.
+     */
+    PipelineContext* context() const ;
   
 
     /** Called at the begin of the job before anything is read.
@@ -141,6 +185,28 @@ struct ExternalProcessorMgrAccessor {
      *  for all following processors.
      */
     virtual void end(){ }
+
+    /** True if the processor can run in the worker processes of the multi-process mode
+     *  (global parameter NumberOfProcesses). Processors have to opt in: every worker 
+     *  process runs all processors on its share of the events, so output written by the 
+     *  processor has to be redirected in workerStarted(). If one of the active processors
+     *  does not allow worker processes Marlin runs with a single process.<br>
+     *  Note that every worker reads and decodes the whole input to find its events. A
+     *  StopProcessing exception thrown in one worker stops the other workers at their 
+     *  next event.
+     */
+    virtual bool allowWorkerProcesses() const { return false ; }
+
+    /** Called in every worker process of the multi-process mode after the fork, i.e. after
+     *  init() and before the first event. Use to redirect output to worker specific files.
+     *  The workers call end() as usual.
+     */
+    virtual void workerStarted( int /*workerID*/ ) { }
+
+    /** Called in the main process of the multi-process mode after all nWorkers workers
+     *  have finished - instead of end(). Use to merge the output of the workers.
+     */
+    virtual void mergeWorkerOutput( int /*nWorkers*/ ) { }
   
 
     /** Return type name for the processor (as set in constructor).
@@ -175,6 +241,7 @@ struct ExternalProcessorMgrAccessor {
     template <class T>
     void printParameters() {
     
+      ConcurrentLogGuard guard ;
       
       if( streamlog::out.template write<T>() ) {
 
@@ -248,6 +315,28 @@ struct ExternalProcessorMgrAccessor {
 
   protected:
 
+    /** Declare the level of concurrency this processor supports - call in the constructor.
+     *  The default is SERIAL_ONLY.
+     */
+    void setConcurrency( Concurrency c ) { _concurrency = c ; }
+
+    /** Declare that init() and end() neither depend on nor interfere with other processors,
+     *  e.g. as they only read their own files - call in the constructor. The output of init()
+     *  and end() to std::cout is buffered and printed in the order of the processors, the
+     *  streamlog_out statements are serialized and use the name and Verbosity of the processor.<br>
+     *  init() and end() then have to be thread safe: they must not use AIDA (an exception is
+     *  thrown), create a streamlog::logscope, write to streamlog::out other than with
+     *  streamlog_out or use other global state such as srand()/rand().
+     *  Registering with the ProcessorEventSeeder is safe.
+     */
+    void setIndependentInit( bool independent=true ) { _independentInit = independent ; }
+
+    /** Declare that the processor has nothing to do if all its input collections are missing
+     *  or empty in the event, i.e. processEvent() and check() need not be called - call in the
+     *  constructor.
+     */
+    void setSkipWithoutInputs( bool skip=true ) { _skipWithoutInputs = skip ; }
+
     /** Set the return value for this processor - typically at end of processEvent(). 
      *  The value can be used in a condition in the steering file referred to by the name
      *  of the processor. 
@@ -260,6 +349,16 @@ struct ExternalProcessorMgrAccessor {
      */
     void setReturnValue( const std::string& name, bool val ) ;
 
+    /** Skip all remaining processors for the current event - call in processEvent() and return.
+     *  Same as throwing a SkipEventException but without the cost of the exception.
+     */
+    void skipEvent() { _skipRequested = true ; }
+
+    /** Stop the event processing and call end() for all processors - call in processEvent() and 
+     *  return. Same as throwing a StopProcessingException from processEvent().
+     */
+    void requestStop() { _stopRequested = true ; }
+
 
     /** Register a steering variable for this processor - call in constructor of processor.
      *  The default value has to be of the _same_ type as the parameter, e.g.<br>
@@ -383,6 +482,7 @@ struct ExternalProcessorMgrAccessor {
     template <class T>
     void message(  const std::string& m ) const {
       
+      ConcurrentLogGuard guard ;
 
       if( streamlog::out.template write<T>() ) 
 	streamlog::out() << m << std::endl ;
@@ -480,6 +580,15 @@ struct ExternalProcessorMgrAccessor {
     LCIOTypeMap   _outTypeMap{};
 
     std::string _logLevelName{};
+
+    Concurrency _concurrency = SERIAL_ONLY ;
+    bool _independentInit = false ;
+    bool _skipWithoutInputs = false ;
+
+    PipelineContext* _context = nullptr ;
+
+    bool _skipRequested = false ;
+    bool _stopRequested = false ;
     
   private:
     mutable std::stringstream* _str=NULL;
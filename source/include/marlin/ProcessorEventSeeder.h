@@ -3,8 +3,11 @@
 
 #include "lcio.h"
 #include "EVENT/LCEvent.h"
+#include "marlin/PhiloxRandom.h"
 #include <vector>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 using namespace lcio ;
 
@@ -12,6 +15,7 @@ namespace marlin{
 
   class ProcessorMgr;  
   class Processor;
+  class PipelineContext;
 
   /** Processor event seeder - provides independent pseudo-randomly generated seeds 
    *  for registered processors on an event by event basis.   
@@ -36,7 +40,26 @@ namespace marlin{
    *             <parameter name="RandomSeed" value="1234567890"/>
    *
    *      Note that the value must be a positive integer, with max value 2,147,483,647
-   *      A pseudo-random event seed is generated using a three step hashing function of unsigned ints,
+   *
+   *      By default the seeds are computed with the counter based random number generator
+   *      Philox4x32-10, using the RandomSeed and a hash of the processor name as key and
+   *      the event and run number as counter. The seeds are only computed when requested
+   *      by a processor, they do not depend on the order in which processors registered or
+   *      events are processed and no global state (e.g. srand/rand) is used or modified.
+   *      Processors that need more than one random number, or independent random numbers
+   *      in several threads, can retrieve a stream of random numbers with:
+   *
+   *             RandomStream stream = Global::EVENTSEEDER->getRandomStream(this);
+   *
+   *      and use stream.substream(i) for the i-th chunk of work within the event.
+   *      The overloads taking the event as argument do not use the state of the current
+   *      event and can be called concurrently for different events.
+   *
+   *      The original seeding scheme can be selected for backward compatibility with:
+   *
+   *             <parameter name="RandomSeedMode" value="JenkinsHash"/>
+   *
+   *	  A pseudo-random event seed is then generated using a three step hashing function of unsigned ints,
    *	  in the following order: event_number, run_number, RandomSeed. The hashed int from each step 
    *	  in the above order is used as input to the next hash step. This is used to ensure that in 
    *	  the likely event of similar values of event_number, run_number and RandomSeed, different 
@@ -45,13 +68,17 @@ namespace marlin{
    *	  The event seed is then used to seed rand via srand(seed) and then rand is used to 
    *	  generate one seed per registered processor.
    *
-   *	  This mechanism ensures reproducible results for every event, regardless of the sequence 
+   *	  Both mechanisms ensure reproducible results for every event, regardless of the sequence 
    *	  in which the event is processed in a Marlin job, whilst maintaining the full 32bit range 
    *	  for event and run numbers.
    *   
    *      If a call is made to getSeed( Processor* ) preceededing a call to registerProcessor( Processor* )
    *      an exception will be thrown.
    *
+   *      Processors initialized for their first event (global parameter LazyInit) register after
+   *      event processing started. In JENKINS_HASH mode their seeds then depend on the order in
+   *      which these processors are first called.
+   *
    *  @author S.J. Aplin, DESY
    */
   class ProcessorEventSeeder {
@@ -60,26 +87,71 @@ namespace marlin{
 
     friend class ProcessorMgr;
 
+    /** Algorithm used for computing the seeds */
+    enum SeedingMode {
+      PHILOX = 0 ,       // counter based, computed on request (default)
+      JENKINS_HASH = 1   // jenkins_hash of event, run and global seed + srand()/rand() 
+    } ;
+
     /** Destructor */
     ~ProcessorEventSeeder() { } ;
     
     /** Called by Processors to register themselves for the seeding service. 
+     *  Can be called concurrently from the init() of independent processors.
      */
     void registerProcessor( Processor* proc ) ;
  
     /** Called by Processors to obtain seed assigned to it for the current event.
      */
     unsigned int getSeed( Processor* proc ) ;
+
+    /** Seed assigned to the processor for the given event - does not depend on the 
+     *  current event and can be called concurrently. Not available in JENKINS_HASH mode.
+     */
+    unsigned int getSeed( Processor* proc, const LCEvent* evt ) const ;
+
+    /** Stream of random numbers assigned to the processor for the current event.
+     *  In JENKINS_HASH mode the stream is keyed with the seed from getSeed( proc ).
+     */
+    RandomStream getRandomStream( Processor* proc ) ;
+
+    /** Stream of random numbers assigned to the processor for the given event - does not
+     *  depend on the current event and can be called concurrently.
+     *  Not available in JENKINS_HASH mode.
+     */
+    RandomStream getRandomStream( Processor* proc, const LCEvent* evt ) const ;
+
+    /** The algorithm used for computing the seeds */
+    SeedingMode seedingMode() const { return _mode ; }
  
   private:
 
-    /** Constructor */
-    ProcessorEventSeeder() ;
+    /** Constructor - the global parameters are taken from the given pipeline context */
+    ProcessorEventSeeder( PipelineContext* ctx ) ;
 
-    /** Create new set of seeds for registered Processors for the given event.
+    /** Set the current event for the registered Processors. In PHILOX mode this only stores
+     *  the event and run number, in JENKINS_HASH mode the seeds of all processors are recomputed.
      *  This method should only be called from ProcessorMgr::processEvent
      */
     void refreshSeeds( LCEvent * evt ) ;
+
+    /** Compute the JENKINS_HASH seeds of all registered processors for the current event */
+    void computeSeeds() ;
+
+    /** Sort the registered processors by the given order - processors initialized
+     *  concurrently register in random order, which would change the JENKINS_HASH seeds.
+     *  Called from ProcessorMgr::init().
+     */
+    void sortRegistered( const std::vector<Processor*>& order ) ;
+
+    /** Read RandomSeed and RandomSeedMode from the global parameters - once per job */
+    void readGlobalParameters() ;
+
+    /** Index of a registered processor - throws an exception if not registered */
+    unsigned getIndex( const Processor* proc ) const ;
+
+    /** Stream for the given processor index, event and run number */
+    RandomStream stream( unsigned index, unsigned int eventNumber, unsigned int runNumber ) const ;
     
     ProcessorEventSeeder(const ProcessorEventSeeder&);	// prevent copying
     ProcessorEventSeeder& operator=(const ProcessorEventSeeder&); // prevent assignment
@@ -97,10 +169,35 @@ namespace marlin{
      */
     bool _eventProcessingStarted ;
 
+    /** Set by the ProcessorMgr while a processor is initialized for its first event (LazyInit)
+     *  - registerProcessor( Processor* proc ) is allowed then
+     */
+    bool _lateInit = false ;
+
+    /** Algorithm used for computing the seeds */
+    SeedingMode _mode ;
+
+    /** The pipeline context this seeder belongs to */
+    PipelineContext* _context ;
+
+    /** Event and run number of the current event */
+    unsigned int _eventNumber ;
+    unsigned int _runNumber ;
+
     /** vector to hold pair of pointers to the registered processors and their assigned seeds
+     *  - the seeds are only used in JENKINS_HASH mode
      */
     std::vector< std::pair<Processor*, unsigned int> > _vector_pair_proc_seed;
 
+    /** hashed processor names used as key for the Philox generator - same order as above */
+    std::vector< unsigned int > _procIds ;
+
+    /** index of the registered processors in the above vectors */
+    std::unordered_map< const Processor*, unsigned > _procIndex ;
+
+    /** serializes registerProcessor() for concurrent init() */
+    std::mutex _mutex{} ;
+
   } ;
 
 } // end namespace marlin 
@@ -5,6 +5,9 @@
 
 #include "LCIOSTLTypes.h"
 
+#include <dlfcn.h>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -17,6 +20,12 @@ namespace marlin{
    *  closed in the destructor, i.e. their lifetime is the same as that 
    *  of the ProcessorLoader instance.
    *
+   *  If a registry cache file is given, the processor types registered by every library
+   *  are written to this file after all libraries have been loaded. If the cache is valid
+   *  for the given libraries (same list, modification times and sizes) the libraries are
+   *  not loaded in the constructor, but only the ones needed with loadForTypes(). Libraries
+   *  that register no processors are always loaded.
+   *
    *  @author F. Gaede, DESY
    *  @version $Id: ProcessorLoader.h,v 1.3 2008-03-11 15:17:14 engels Exp $ 
    */
@@ -28,18 +37,55 @@ namespace marlin{
   public:
     
     ProcessorLoader( lcio::StringVec::const_iterator  first, lcio::StringVec::const_iterator last ) ;
+
+    /** Load the libraries lazily if the given registry cache file is valid - if not, all
+     *  libraries are loaded and the cache file is (re-)written.
+     */
+    ProcessorLoader( lcio::StringVec::const_iterator  first, lcio::StringVec::const_iterator last,
+		     const std::string& registryCacheFile ) ;
     
     virtual ~ProcessorLoader() ;
 
     bool failedLoading() { return _loadError; };
+
+    /** True if all libraries have been loaded */
+    bool allLoaded() const { return _loaded.size() == _libNames.size() ; }
+
+    /** Load all libraries that have not been loaded yet.
+     */
+    void loadAll() ;
+
+    /** Load the libraries that provide the given processor types according to the registry
+     *  cache and all libraries without processors, which are given for their symbols. The
+     *  symbols are resolved at load time - falls back to loadAll() if a type is not in the
+     *  cache or loading fails.
+     */
+    void loadForTypes( const std::set<std::string>& types ) ;
     
     
   protected:
+
+    /** Load the i-th library with the given dlopen mode and record the processor types it registers */
+    void loadLibrary( unsigned i, int mode=RTLD_LAZY | RTLD_GLOBAL ) ;
+
+    /** Read the registry cache - true if it is valid for the current libraries */
+    bool readCache() ;
+
+    /** Write the registry cache after all libraries have been loaded - to a temporary file
+     *  created with mkstemp() that is renamed to the cache file
+     */
+    void writeCache() const ;
     
     LibVec _libs{};
 
   private:
     bool _loadError=false;
+
+    lcio::StringVec _libNames{} ;
+    std::set<unsigned> _loaded{} ;
+    std::set<std::string> _checkDuplicateLibs{} ;
+    std::string _cacheFile{} ;
+    std::map< std::string, unsigned > _typeToLib{} ;
   };
 
 } // end namespace marlin 
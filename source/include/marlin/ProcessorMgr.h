@@ -12,23 +12,29 @@
 #include "EVENT/LCRunHeader.h"
 #include "LogicalExpressions.h"
 
+#include <iostream>
 #include <map>
 #include <set>
 #include <list>
+#include <memory>
+#include <vector>
 
 using namespace lcio ;
 
 namespace marlin{
 
   class ProcessorEventSeeder;
+  class PipelineContext;
 
 typedef std::map< const std::string , Processor* > ProcessorMap ;
 typedef std::list< Processor* > ProcessorList ;
 typedef std::map< const std::string , int > SkippedEventMap ;
+typedef std::map< Processor* , std::pair< double  , int > > ProcessorTimeMap ;
 
 /** Processor manager singleton class. Holds references to all registered Processors. 
  *    
  *  Responsible for creating the instance of ProcessorEventSeeder and setting the Global::EVENTSEEDER variable.
+ *  Additional independent managers are owned by a PipelineContext, see there.
  * 
  *  @author F. Gaede, DESY
  *  @version $Id: ProcessorMgr.h,v 1.16 2007-08-13 10:38:39 gaede Exp $ 
@@ -38,13 +44,24 @@ class ProcessorMgr : public LCRunListener, public LCEventListener {
 friend class  Processor ;   
 friend class  CMProcessor ;   
 friend class  MarlinSteerCheck ;   
+friend class  ProcessorLoader ;   
 
 public:
   
-  /** Return the instance of this manager.
+  /** Return the manager of the current PipelineContext - the instance of the Marlin application,
+   *  unless called from within the processors of another pipeline.
    */
   static ProcessorMgr* instance() ;
 
+  /** True if called from init() or end() of a processor that runs concurrently with other
+   *  independent processors (ParallelInit) - global services that are not thread safe,
+   *  e.g. AIDA, refuse to be used then.
+   */
+  static bool inConcurrentCall() ;
+
+  /** The context this manager belongs to */
+  PipelineContext* context() const { return _context ; }
+
   /** destructor deletes ProcessorEventSeeder
    */
   virtual ~ProcessorMgr() ;
@@ -98,6 +115,37 @@ public:
   virtual void readDataSource( int numEvents ) ;
 
 
+  /** Multi-process mode: false if one of the active processors does not allow to run in
+   *  worker processes, see Processor::allowWorkerProcesses().
+   */
+  bool allowWorkerProcesses() const ;
+
+  /** Multi-process mode: called in the worker process after the fork - calls 
+   *  Processor::workerStarted() for all active processors. The worker does not print the 
+   *  skip and timing statistics in end().
+   */
+  void workerStarted( int workerID ) ;
+
+  /** Multi-process mode: position of the current event or run header in the input, i.e. the
+   *  number of events read before it - -1 in single process mode. Used by the processors to
+   *  merge the output of the workers in input order.
+   */
+  long inputEventIndex() const { return _inputEventIndex ; }
+
+  /** Set the input position of the current event or run header - called by the MultiProcessRunner */
+  void setInputEventIndex( long index ) { _inputEventIndex = index ; }
+
+  /** Write the skip and timing statistics of this process, e.g. of a worker process */
+  void writeStatistics( std::ostream& out ) const ;
+
+  /** Add the statistics written by a worker process with writeStatistics() */
+  void addStatistics( std::istream& in ) ;
+
+  /** end() of the main process in multi-process mode: calls Processor::mergeWorkerOutput()
+   *  instead of Processor::end() and prints the combined statistics of all workers.
+   */
+  void endWorkers( int nWorkers ) ;
+
   /** Set the return value for the given processor */
   virtual void setProcessorReturnValue( Processor* proc, bool val ) ;
 
@@ -117,14 +165,63 @@ protected:
 //   ProcessorMgr() {}
   ProcessorMgr() ;
 
+  /** Create the manager of a non-default pipeline */
+  ProcessorMgr( PipelineContext* ctx ) ;
+
+  /** The instance for the default context */
+  static ProcessorMgr* defaultInstance() ;
+
+  /** Handle Processor::skipEvent() and Processor::requestStop() after the processor has been called:
+   *  returns true if the event is to be skipped, throws a StopProcessingException if requested.
+   */
+  bool eventAborted( Processor* proc ) ;
+
+  /** Print the events skipped by processors and the time used in processEvent() */
+  void printStatistics() ;
+
+  /** Bookkeeping after init() of the given processor */
+  void processorInitialized( Processor* proc ) ;
+
+  /** True if the processor is to be skipped as all its input collections are missing or
+   *  empty in the event (SkipWithoutInputs) - counts the skipped calls.
+   */
+  bool inputsMissing( Processor* proc , LCEvent* evt ) ;
+
+  /** Initialize a conditional processor before its first event (LazyInit) - the current
+   *  run header is passed to processRunHeader().
+   */
+  void lazyInit( Processor* proc ) ;
+
+  /** True if the global parameter ParallelInit is true */
+  bool parallelInit() const ;
+
+  /** Call the given method (init or end) of the processors concurrently - their output is
+   *  buffered and printed in order, the first exception thrown is rethrown.
+   */
+  void callConcurrently( const std::vector<Processor*>& procs , void (Processor::*method)() ,
+                         const std::string& phaseName ) ;
+
+  friend class PipelineContext ;
+
 private:
   static ProcessorMgr*  _me ;
+  PipelineContext* _context ;
   ProcessorMap _map{};
   ProcessorMap _activeMap{};
   ProcessorList _list{};
   SkippedEventMap _skipMap{};
 
   ProcessorList _eventModifierList{};
+  ProcessorTimeMap _timeMap{};
+  std::map< Processor* , int > _skipCountMap{};
+  int _workerID = -1 ;
+  long _inputEventIndex = -1 ;
+  std::set<Processor*> _conditional{} ;
+  std::set<Processor*> _uninitialized{} ;
+  std::unique_ptr<LCRunHeader> _currentRun{} ;
+  std::map< Processor* , StringVec > _inputCollections{} ;
+  SkippedEventMap _noInputMap{} ;
+  int _nWorkers = 0 ;
 
   LogicalExpressions _conditions{};
 //   LCIOOutputProcessor* _outputProcessor ;
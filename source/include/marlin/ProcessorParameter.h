@@ -49,6 +49,13 @@ namespace marlin{
     
     
     virtual void setValue(  StringParameters* params )=0 ;
+
+    /** Copy the value from the given parameter of the same type, e.g. when cloning a processor.
+     *  Implemented by ProcessorParameter_t - other subclasses cannot be cloned.
+     */
+    virtual void copyValue( ProcessorParameter* /*other*/ ) {
+      throw Exception( std::string("ProcessorParameter::copyValue: not implemented for parameter ") + _name ) ;
+    }
     
   protected:
     
@@ -186,6 +193,17 @@ namespace marlin{
       setProcessorParameter< T >( this , params ) ;
       
     }
+
+    void copyValue( ProcessorParameter* other ) {
+
+      ProcessorParameter_t<T>* p = dynamic_cast< ProcessorParameter_t<T>* >( other ) ;
+
+      if( p == 0 ) {
+	throw Exception( std::string("ProcessorParameter::copyValue: type mismatch for parameter ") + _name ) ;
+      }
+      _parameter = p->_parameter ;
+      _valueSet = p->_valueSet ;
+    }
     
   protected:
     T& _parameter ;
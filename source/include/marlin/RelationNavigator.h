@@ -0,0 +1,106 @@
+#ifndef RelationNavigator_h
+#define RelationNavigator_h 1
+
+#include "lcio.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EVENT{
+  class LCCollection ;
+  class LCEvent ;
+  class LCObject ;
+}
+
+namespace marlin{
+
+  /** Navigator for one direction of an LCRelation collection with the relations in flat
+   *  arrays sorted by the source object - a lookup is a binary search instead of a map of
+   *  vectors as in UTIL::LCRelationNavigator.
+   *
+   *  The navigator of a collection and direction is built once per event on the first
+   *  request and shared by all processors through the EventDataService:
+   *
+   *  <pre>
+   *    auto nav = RelationNavigator::get( evt, "MCTruthMapping", RelationNavigator::FROM_TO ) ;
+   *
+   *    RelationNavigator::Range mcps = nav->related( rec ) ;
+   *    for( size_t i=0 ; i < mcps.size() ; ++i )
+   *      use( mcps[i], mcps.weight(i) ) ;
+   *  </pre>
+   *
+   *  The related objects of a source are in the order of the relations in the collection.
+   *  As in UTIL::LCRelationNavigator, several relations between the same two objects are
+   *  merged into one relation whose weight is the sum of their weights.
+   */
+  class RelationNavigator {
+
+  public:
+
+    /** Direction of the navigation */
+    enum Direction {
+      FROM_TO = 0 ,  // related 'to' objects of a 'from' object
+      TO_FROM = 1    // related 'from' objects of a 'to' object
+    } ;
+
+    /** The objects related to one object and the weights of the relations */
+    class Range {
+    public:
+      Range( EVENT::LCObject* const* objects, const float* weights, size_t n ) :
+	_objects( objects ), _weights( weights ), _size( n ) {}
+
+      size_t size() const { return _size ; }
+      bool empty() const { return _size == 0 ; }
+
+      EVENT::LCObject* operator[]( size_t i ) const { return _objects[i] ; }
+      float weight( size_t i ) const { return _weights[i] ; }
+
+      EVENT::LCObject* const* begin() const { return _objects ; }
+      EVENT::LCObject* const* end() const { return _objects + _size ; }
+
+    private:
+      EVENT::LCObject* const* _objects ;
+      const float* _weights ;
+      size_t _size ;
+    } ;
+
+    /** The navigator of the named LCRelation collection in the event for the given direction -
+     *  built on the first request in the event.
+     */
+    static std::shared_ptr<const RelationNavigator> get( EVENT::LCEvent* evt, const std::string& colName,
+							 Direction direction ) ;
+
+    /** Build the navigator for an LCRelation collection */
+    RelationNavigator( const EVENT::LCCollection* col, Direction direction ) ;
+
+    RelationNavigator( const RelationNavigator& ) = delete ;
+    RelationNavigator& operator=( const RelationNavigator& ) = delete ;
+
+    Direction direction() const { return _direction ; }
+
+    /** Type of the source and the related objects (FromType/ToType of the collection) */
+    const std::string& sourceType() const { return _sourceType ; }
+    const std::string& relatedType() const { return _relatedType ; }
+
+    /** The objects related to obj - empty if there are none */
+    Range related( const EVENT::LCObject* obj ) const ;
+
+    /** Number of relations - relations between the same objects counted once */
+    size_t size() const { return _related.size() ; }
+
+  protected:
+
+    Direction _direction ;
+    std::string _sourceType{} ;
+    std::string _relatedType{} ;
+
+    // sorted by source, relations of the same source in collection order
+    std::vector<const EVENT::LCObject*> _sources{} ;
+    std::vector<EVENT::LCObject*> _related{} ;
+    std::vector<float> _weights{} ;
+  } ;
+
+} // end namespace marlin
+#endif
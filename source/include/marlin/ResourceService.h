@@ -0,0 +1,89 @@
+#ifndef ResourceService_h
+#define ResourceService_h 1
+
+#include "marlin/Exceptions.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+
+namespace marlin{
+
+  /** Service for named, immutable resources that are shared between processors and their
+   *  clones, e.g. field maps, calibration constants or lookup tables. The resource is
+   *  created by the given factory on the first call to get() - concurrent callers wait for
+   *  it - and all later calls return the same instance:
+   *
+   *  <pre>
+   *    _table = Global::RESOURCES->get<LookupTable>( "MyTable", [&](){ return new LookupTable( _fileName ) ; } ) ;
+   *  </pre>
+   *
+   *  Resources registered with scope RUN are invalidated by the ProcessorMgr at every new run,
+   *  the next get() creates a new instance. Instances still referenced by processors stay valid.
+   *  The instance is held by Global::RESOURCES.
+   */
+  class ResourceService {
+
+  public:
+
+    /** Lifetime of a resource */
+    enum Scope {
+      JOB = 0 ,  // created once per job
+      RUN = 1    // re-created after every new run header
+    } ;
+
+    ResourceService() = default ;
+    ResourceService( const ResourceService& ) = delete ;
+    ResourceService& operator=( const ResourceService& ) = delete ;
+
+    /** Return the resource with the given name - created with factory() if it does not exist.
+     *  The factory has to return a T* (ownership is taken) or a std::shared_ptr<T>.
+     *  Throws an Exception if the resource exists with a different type or scope.
+     */
+    template <class T, class Factory>
+    std::shared_ptr<const T> get( const std::string& name, Factory factory, Scope scope=JOB ) {
+
+      std::shared_ptr<Entry> e = entry( name, typeid(T), scope ) ;
+
+      std::lock_guard<std::mutex> lock( e->mutex ) ;
+
+      if( ! e->resource ) {
+	e->resource = std::shared_ptr<const T>( factory() ) ;
+
+	if( ! e->resource )
+	  throw Exception( std::string("ResourceService: factory returned no instance for resource ") + name ) ;
+      }
+      return std::static_pointer_cast<const T>( e->resource ) ;
+    }
+
+    /** True if the resource with the given name has been created (and not invalidated) */
+    bool exists( const std::string& name ) const ;
+
+    /** Drop all resources with scope RUN - called by the ProcessorMgr for every new run */
+    void invalidateRun() ;
+
+    /** Drop all resources */
+    void clear() ;
+
+  protected:
+
+    struct Entry {
+      Entry( const std::type_info& t, Scope s ) : type( t ), scope( s ) {}
+      std::type_index type ;
+      Scope scope ;
+      std::mutex mutex{} ;
+      std::shared_ptr<const void> resource{} ;
+    } ;
+
+    /** Return the entry for the given name - creates it if needed */
+    std::shared_ptr<Entry> entry( const std::string& name, const std::type_info& type, Scope scope ) ;
+
+    mutable std::mutex _mutex{} ;
+    std::map< std::string, std::shared_ptr<Entry> > _entries{} ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -6,6 +6,7 @@
 #ifdef MARLIN_CLHEP  // only if CLHEP is available !
 
 #include "marlin/IFourVectorSmearer.h"
+#include "marlin/PolarAngleBinning.h"
 #include <vector>
 
 namespace marlin{
@@ -62,11 +63,27 @@ namespace marlin{
      *  no resolution is defined.
      */ 
     virtual HepLorentzVector smearedFourVector( const HepLorentzVector& v, int pdgCode ) ;
+
+    /** Smears all four vectors of the arrays - the resolutions are looked up first and
+     *  the Gaussian random numbers are drawn in one batch - from v.random with the
+     *  ZigguratGaussian if set, else with CLHEP::RandGauss.
+     */
+    virtual void smearFourVectors( FourVectorArrays& v ) ;
+
+    /** The batch smearing only reads the resolutions - true.
+     */
+    virtual bool usesRandomStream() const { return true ; }
     
   protected:
 
+    /** Index of the resolution for the polar angle theta in [0,pi/2] - -1 if none is defined */
+    int resolutionIndex( double theta ) const { return _bins.index( theta ) ; }
+
     ResVec _resVec ;
 
+    /** direct index lookup of the polar angle ranges of _resVec */
+    PolarAngleBinning _bins{} ;
+
   } ;
   
 
@@ -6,6 +6,7 @@
 
 #include "lcio.h"
 #include <string>
+#include <vector>
 
 
 
@@ -43,6 +44,28 @@ namespace marlin{
    *  A collection of LCRelations, called "MCTruthMapping" holds the relation between the 
    *  ReconstructedParticles and their proper MCParticles.
    *
+   *  Finely binned resolution maps can be read from the <b>ResolutionFile</b>, holding one
+   *  polar angle range per line with the parameter name and its values, e.g.<br>
+   *  <b>ChargedResolution  &nbsp; 2e-5 &nbsp; 0.10 &nbsp; 0.11</b><br>
+   *  Lines starting with '#' are ignored. The ranges of a particle type in the file replace
+   *  the ones given in the steering file. The resolution for a polar angle is found with
+   *  a direct index lookup, independent of the number of ranges.
+   *
+   *  With <b>BatchMode</b> true the stable MCParticles of the event are smeared in one batch
+   *  per particle type (see IRecoParticleFactory::createReconstructedParticles()). The random
+   *  numbers are then drawn with the ZigguratGaussian from the random stream of the processor
+   *  for the event (see ProcessorEventSeeder), i.e. the results are reproducible for every
+   *  event independently of other processors and threads, but differ from the default mode.
+   *  The particles are split into chunks of <b>ChunkSize</b> particles, chunk i draws from
+   *  substream i of the event. The results therefore depend on ChunkSize: only ChunkSize 0,
+   *  a single chunk drawing from the stream of the event, gives the results of the batch mode
+   *  without chunks - the default of 1000 does not, not even for smaller events.
+   *  With <b>NumberOfThreads</b> larger than one the four vectors of the chunks are smeared
+   *  concurrently and the ReconstructedParticles are created on the calling thread in input
+   *  order - as the chunks do not depend on the number of threads, the output is identical
+   *  to the one with a single thread. This requires a particle factory that supports concurrent
+   *  smearing (IRecoParticleFactory::supportsConcurrentSmearing()), else one thread is used.
+   *
    * 
    *  <h4>Input - Prerequisites</h4>
    *  A collection of MCParticles (the MCPArticle collection).
@@ -56,9 +79,13 @@ namespace marlin{
    * 
    * @param ChargedResolution    Resolution of charged particles in polar angle range:  d(1/P)  th_min  th_max
    * @param InputCollectionName  Name of the MCParticle input collection
+   * @param BatchMode            Smear the particles of the event in one batch per particle type
+   * @param ChunkSize            Number of particles per chunk in BatchMode - 0 for one chunk per event, the results depend on it
    * @param MomentumCut          No reconstructed particles are produced for smaller momenta (in [GeV])
+   * @param NumberOfThreads      Number of threads for the chunks of an event - larger than one implies BatchMode
    * @param NeutralHadronResolution Resolution dE/E=A+B/sqrt(E/GeV) of neutral hadrons in polar angle range: A  B th_min  th_max
    * @param PhotonResolution   Resolution dE/E=A+B/sqrt(E/GeV) of photons in polar angle range: A  B th_min  th_max
+   * @param ResolutionFile     File with resolution maps - replaces the resolutions of the particle types in the file
    *
    * @param RecoParticleCollectionName    default is "ReconstructedParticles"
    * @param MCTruthMappingCollectionName  default is "MCTruthMapping"
@@ -98,6 +125,21 @@ namespace marlin{
     /** Called after data processing for clean up.
      */
     virtual void end() ;
+
+    /** Events are smeared independently with their own random seeds - can run in worker processes.
+     */
+    virtual bool allowWorkerProcesses() const { return true ; }
+
+    /** Creates the ReconstructedParticles in chunks of chunkSize particles, 0 for a single chunk -
+     *  recs[i] is the particle for mcps[i] or NULL. Chunk c draws from substream c of the stream,
+     *  a single chunk from the stream itself. If the factory supports concurrent smearing, the
+     *  chunks are smeared on nThreads threads, the particles are always created on the calling
+     *  thread - the results do not depend on nThreads.
+     */
+    static void createInChunks( IRecoParticleFactory* factory, const RandomStream& stream,
+				size_t chunkSize, unsigned nThreads,
+				const std::vector<const MCParticle*>& mcps,
+				std::vector<ReconstructedParticle*>& recs ) ;
     
     
   protected:
@@ -121,9 +163,24 @@ namespace marlin{
     /** Resolutions of photons */
     FloatVec _initNeutralHadronRes{};
 
+    /** Read the resolutions from the file into the parameter vectors */
+    void readResolutionFile( const std::string& fileName ) ;
+
+    /** File with resolution maps */
+    std::string _resolutionFile{};
+
     /** The particle factory */
     IRecoParticleFactory* _factory=NULL;
 
+    /** smear the particles of the event in one batch */
+    bool _batchMode=false;
+
+    /** particles per chunk in batch mode */
+    int _chunkSize=1000;
+
+    /** threads for the chunks of an event */
+    int _nThreads=1;
+
     int _nRun=-1;
     int _nEvt=-1;
     
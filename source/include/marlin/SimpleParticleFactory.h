@@ -34,6 +34,29 @@ namespace marlin {
     /** The actual factory method that creates a new ReconstructedParticle
      */ 
     virtual lcio::ReconstructedParticle* createReconstructedParticle( const lcio::MCParticle* mcp ) ;
+
+    /** Batch version of createReconstructedParticle(): calls smearParticles() and
+     *  createParticles().
+     */
+    virtual void createReconstructedParticles( const lcio::MCParticle* const* mcps, size_t n,
+					       lcio::ReconstructedParticle** recs,
+					       RandomStream* random = 0 ) ;
+
+    /** True if all registered smearers draw their random numbers from the random stream.
+     */
+    virtual bool supportsConcurrentSmearing() const ;
+
+    /** The particles are classified and the four vectors of every type are smeared in one call
+     *  to IFourVectorSmearer::smearFourVectors() - every particle type draws from its own
+     *  substream of random.
+     */
+    virtual void smearParticles( const lcio::MCParticle* const* mcps, size_t n,
+				 SmearedParticles& s, RandomStream* random ) ;
+
+    /** Creates the ReconstructedParticles in one pass in input order.
+     */
+    virtual void createParticles( const lcio::MCParticle* const* mcps, size_t n,
+				  const SmearedParticles& s, lcio::ReconstructedParticle** recs ) ;
     
     
     /** Register a particle four vector smearer for the given type.
@@ -56,6 +79,12 @@ namespace marlin {
     virtual void setMomentumCut( double mCut ) ;
 
   protected:
+
+    /** Creates the ReconstructedParticle for the smeared four vector - NULL if the momentum
+     *  is below the cut.
+     */
+    lcio::ReconstructedParticle* createParticle( const lcio::MCParticle* mcp, FastMCParticleType type,
+						 double px, double py, double pz, double e ) const ;
     
     std::vector<IFourVectorSmearer*> _smearingVec ;
     double _momentumCut ;
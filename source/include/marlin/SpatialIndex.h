@@ -0,0 +1,118 @@
+#ifndef SpatialIndex_h
+#define SpatialIndex_h 1
+
+#include "marlin/HitSoAView.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace marlin{
+
+  /** Neighbour search structure over the hits of a collection, shared by all processors
+   *  of an event through the EventDataService - built on the first request in the event:
+   *
+   *  <pre>
+   *    auto index = SpatialIndex::get( evt, "EcalBarrelHits", SpatialIndex::UNIFORM_GRID, 20. ) ;
+   *
+   *    std::vector<size_t> neighbours ;
+   *    index->findNeighbours( x, y, z, 30., neighbours ) ;
+   *    for( size_t i : neighbours )
+   *      CalorimeterHit* hit = index->hits().hit<CalorimeterHit>( i ) ;
+   *  </pre>
+   *
+   *  The indices returned refer to the HitSoAView of the collection, see hits().
+   *  Several indices can be built concurrently in advance with prepare().
+   */
+  class SpatialIndex {
+
+  public:
+
+    /** Type of the index */
+    enum Type {
+      UNIFORM_GRID = 0 ,  // 3D grid of cubic cells of the given size
+      KD_TREE = 1 ,       // balanced kd-tree
+      LAYER_GRID = 2      // 2D grid in x-y for every layer (cellID field "layer")
+    } ;
+
+    /** Parameters of an index for prepare() */
+    struct Request {
+      std::string collection ;
+      Type type ;
+      float cellSize ;
+    } ;
+
+    /** The index of the given type over the named hit collection in the event - built on the
+     *  first request in the event. The cellSize (in mm) is used for the grids, indices of the
+     *  same collection and type with different cell sizes are independent.
+     */
+    static std::shared_ptr<const SpatialIndex> get( EVENT::LCEvent* evt, const std::string& colName,
+						    Type type, float cellSize=10.f ) ;
+
+    /** Build the requested indices for the event concurrently on at most hardware_concurrency
+     *  threads, including the calling thread - later calls to get() return them immediately.
+     */
+    static void prepare( EVENT::LCEvent* evt, const std::vector<Request>& requests ) ;
+
+    /** Build the index over the given hits - the layer of every hit (needed for LAYER_GRID)
+     *  is decoded from the cellID with the given CellIDEncoding. Throws an Exception if a hit
+     *  has a non-finite position.
+     */
+    SpatialIndex( std::shared_ptr<const HitSoAView> hits, Type type, float cellSize,
+		  const std::string& encoding="" ) ;
+
+    SpatialIndex( const SpatialIndex& ) = delete ;
+    SpatialIndex& operator=( const SpatialIndex& ) = delete ;
+
+    Type type() const { return _type ; }
+
+    /** The hits of the index */
+    const HitSoAView& hits() const { return *_hits ; }
+
+    /** Append the indices of all hits within the given radius around (x,y,z) to result */
+    void findNeighbours( float x, float y, float z, float radius, std::vector<size_t>& result ) const ;
+
+    /** Append the indices of all hits in the given layer within the given radius around
+     *  (x,y,z) to result - LAYER_GRID only.
+     */
+    void findNeighboursInLayer( int layer, float x, float y, float z, float radius,
+				std::vector<size_t>& result ) const ;
+
+    /** Index of the hit closest to (x,y,z) - size() of the hits if there are none */
+    size_t nearest( float x, float y, float z ) const ;
+
+  protected:
+
+    /** Uniform grid over a subset of the hits - cells are sorted, cellStart[c] is the
+     *  position of the first hit of cell c in order.
+     */
+    struct Grid {
+      float min[3] = { 0.f, 0.f, 0.f } ;
+      int n[3] = { 1, 1, 1 } ;
+      float cellSize = 1.f ;
+      std::vector<unsigned> cellStart{} ;
+      std::vector<unsigned> order{} ;
+    } ;
+
+    void buildGrid( Grid& grid, const std::vector<unsigned>& hits, int dims ) const ;
+    void searchGrid( const Grid& grid, float x, float y, float z, float radius, std::vector<size_t>& result ) const ;
+
+    void buildTree( unsigned first, unsigned last, int depth ) ;
+    void searchTree( unsigned first, unsigned last, int depth, const float* p, float r2, std::vector<size_t>& result ) const ;
+    void nearestInTree( unsigned first, unsigned last, int depth, const float* p, size_t& best, float& best2 ) const ;
+
+    /** Squared distance of hit i to p */
+    float distance2( size_t i, const float* p ) const ;
+
+    std::shared_ptr<const HitSoAView> _hits ;
+    Type _type ;
+    float _cellSize ;
+
+    Grid _grid{} ;                           // UNIFORM_GRID
+    std::vector<unsigned> _tree{} ;          // KD_TREE: median of [first,last) at the middle
+    std::map<int, Grid> _layers{} ;          // LAYER_GRID
+  } ;
+
+} // end namespace marlin
+#endif
@@ -0,0 +1,94 @@
+#ifndef StartupProfiler_h
+#define StartupProfiler_h 1
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace marlin{
+
+  /** Records wall time and growth of the resident memory for the phases of the Marlin
+   *  startup before the first event: loading of every shared library, the parser phases,
+   *  the creation of the processors, GEAR and the init() of every processor.
+   *
+   *  For shared libraries the time from the first processor registration (i.e. the first
+   *  static prototype being constructed) to the return of dlopen is reported separately as
+   *  an estimate of the time spent in static initialisers, the rest is mostly loading and
+   *  relocation.
+   *
+   *  The profile is printed at MESSAGE level if the global parameter StartupProfile is true
+   *  and written as JSON to the file given in StartupProfileFile.
+   */
+  class StartupProfiler {
+
+  public:
+
+    /** Measurement of one startup phase - from construction to stop() or destruction.
+     */
+    class Phase {
+    public:
+      Phase( const std::string& category, const std::string& name ) ;
+      ~Phase() { stop() ; }
+      Phase( const Phase& ) = delete ;
+      Phase& operator=( const Phase& ) = delete ;
+
+      /** Stop the measurement and record the phase */
+      void stop() ;
+
+    private:
+      std::string _category ;
+      std::string _name ;
+      std::chrono::steady_clock::time_point _start ;
+      long _rss ;
+      Phase* _previous ;
+      bool _stopped ;
+      bool _registered = false ;
+      std::chrono::steady_clock::time_point _firstRegistration{} ;
+
+      friend class StartupProfiler ;
+    } ;
+
+    /** One recorded phase */
+    struct Record {
+      std::string category ;
+      std::string name ;
+      double seconds ;
+      double staticInitSeconds ;  // < 0 if no processor has been registered in this phase
+      long rssKB ;
+    } ;
+
+    static StartupProfiler* instance() ;
+
+    /** Called by the ProcessorMgr when a processor prototype is registered */
+    void processorRegistered() ;
+
+    /** Stop recording - called when the startup is finished */
+    void finish() ;
+
+    /** Discard all records and start again - e.g. for a job forked from a Marlin server */
+    void restart() ;
+
+    /** Print the profile at MESSAGE level */
+    void print() const ;
+
+    /** Write the profile in JSON format to the given file */
+    void writeJSON( const std::string& fileName ) const ;
+
+    /** Resident memory of the process in kB (0 if not available) */
+    static long residentKB() ;
+
+  private:
+
+    StartupProfiler() ;
+
+    std::chrono::steady_clock::time_point _start ;
+    long _startRSS ;
+    double _total = 0. ;
+    long _totalRSS = 0 ;
+    bool _active = true ;
+    Phase* _current = nullptr ;
+    std::vector<Record> _records{} ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -45,6 +45,10 @@ class Statusmonitor : public Processor {
   /** Called after data processing for clean up.
    */
   virtual void end() ;
+
+  /** Every worker process prints the status of its own events.
+   */
+  virtual bool allowWorkerProcesses() const { return true ; }
   
   
  protected:
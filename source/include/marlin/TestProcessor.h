@@ -52,6 +52,10 @@ namespace marlin {
     /** Called after data processing for clean up.
      */
     virtual void end() ;
+
+    /** Every worker process prints its own events.
+     */
+    virtual bool allowWorkerProcesses() const { return true ; }
     
     
   protected:
@@ -53,8 +53,45 @@ namespace marlin{
   using  streamlog::ERROR9 ;
   using  streamlog::SILENT ;
 
+
+  class Processor ;
+
+  /** Guards the global streamlog::out while independent processors are called concurrently
+   *  (global parameter ParallelInit): the output statements of the threads are serialized and
+   *  use the name and Verbosity of the processor the thread calls. Does nothing otherwise.
+   *  Created by the streamlog_out macro for the duration of the statement.
+   */
+  class ConcurrentLogGuard{
+
+  public:
+
+    ConcurrentLogGuard() { if( threadProcessor != 0 ) lock() ; }
+    ~ConcurrentLogGuard() { if( _scope != 0 ) unlock() ; }
+
+    ConcurrentLogGuard( const ConcurrentLogGuard& ) = delete ;
+    ConcurrentLogGuard& operator=( const ConcurrentLogGuard& ) = delete ;
+
+    /** Same as streamlog::out.write<T>() */
+    template <class T>
+    bool write() { return streamlog::out.template write<T>() ; }
+
+    /** The processor called concurrently by this thread - NULL outside ProcessorMgr::callConcurrently() */
+    static thread_local const Processor* threadProcessor ;
+
+  private:
+
+    void lock() ;
+    void unlock() ;
+
+    streamlog::logscope* _scope = 0 ;
+  } ;
+
 }
 
+// streamlog_out with the ConcurrentLogGuard - it lives until the end of the statement
+#undef streamlog_out
+#define streamlog_out( VERBOSITY ) marlin::ConcurrentLogGuard().write< streamlog::VERBOSITY >() && streamlog::out()
+
 #endif
 
 
@@ -164,6 +164,13 @@ namespace marlin{
     
     /** Write the parsed XML tree in an other file */
     void write(const std::string &filen) const ;
+
+    /** Return all sections of the parsed steering file */
+    const StringParametersMap& getParametersMap() const { return _map ; }
+
+    /** Return the files included with <include ref="..."/> */
+    const std::vector<std::string>& getIncludedFiles() const { return _includedFiles ; }
+
   protected:
 
     /** Extracts all parameters from the given node and adss them to the current StringParameters object
@@ -207,6 +214,8 @@ namespace marlin{
 
     std::string _fileName ;
 
+    std::vector<std::string> _includedFiles{} ;
+
   private:
     XMLParser() = delete;
     XMLParser(const marlin::XMLParser&) = delete;
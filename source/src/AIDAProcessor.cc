@@ -3,6 +3,7 @@
 #ifdef MARLIN_AIDA
 
 #include "marlin/AIDAProcessor.h"
+#include "marlin/ProcessorMgr.h"
 
 #include <iostream>
 #include <assert.h>
@@ -206,6 +207,11 @@ namespace marlin {
 		      " first processor in your execute section !" ) ; 
     }
 
+    if( ProcessorMgr::inConcurrentCall() ) {
+      throw Exception( std::string(" AIDA can't be used concurrently - processor ") + proc->name() 
+		       + " must not call setIndependentInit() if it uses AIDA in init() or end()" ) ;
+    }
+
     if( !_me->_tree->cd( "/" + proc->name() ) ) {
       _me->_tree->mkdir( "/" + proc->name() ) ; 
       _me->_tree->cd(    "/" + proc->name() ) ;
@@ -0,0 +1,287 @@
+#include "marlin/CachedXMLParser.h"
+#include "marlin/Exceptions.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace marlin{
+
+  namespace {
+
+    const char cacheMagic[8] = { 'M','A','R','L','I','N','S','C' } ;
+    const uint32_t cacheVersion = 1 ;
+
+    std::string readFile( const std::string& fileName, bool& ok ) {
+      std::ifstream in( fileName.c_str(), std::ios::binary ) ;
+      std::stringstream ss ;
+      ok = bool( in ) ;
+      if( ok )
+	ss << in.rdbuf() ;
+      return ss.str() ;
+    }
+
+    void writeInt( std::ostream& out, uint64_t i ) {
+      out.write( reinterpret_cast<const char*>( &i ), sizeof( i ) ) ;
+    }
+
+    void writeString( std::ostream& out, const std::string& s ) {
+      writeInt( out, s.size() ) ;
+      out.write( s.data(), s.size() ) ;
+    }
+
+    bool readInt( std::istream& in, uint64_t& i ) {
+      return bool( in.read( reinterpret_cast<char*>( &i ), sizeof( i ) ) ) ;
+    }
+
+    bool readString( std::istream& in, std::string& s ) {
+      uint64_t n = 0 ;
+      if( ! readInt( in, n ) || n > ( 1u << 30 ) )
+	return false ;
+      s.resize( n ) ;
+      return n == 0 || bool( in.read( &s[0], n ) ) ;
+    }
+  }
+
+
+  CachedXMLParser::CachedXMLParser( const std::string& fileName, const std::string& cacheDir ) :
+    _fileName( fileName ), _cacheDir( cacheDir ) {
+  }
+
+  CachedXMLParser::~CachedXMLParser() {
+  }
+
+
+  uint64_t CachedXMLParser::hash( const std::string& data, uint64_t h ) {
+
+    for( unsigned i=0 ; i < data.size() ; ++i ) {
+      h ^= (unsigned char) data[i] ;
+      h *= 1099511628211ULL ;
+    }
+    return h ;
+  }
+
+
+  void CachedXMLParser::setCmdLineParameters( const CommandLineParametersMap & cmdlineparams ) {
+    _cmdlineparams = cmdlineparams ;
+  }
+
+
+  std::string CachedXMLParser::cacheFileName() const {
+
+    bool ok ;
+    uint64_t h = hash( _fileName ) ;
+    h = hash( readFile( _fileName, ok ), h ) ;
+
+    for( CommandLineParametersMap::const_iterator it = _cmdlineparams.begin() ; it != _cmdlineparams.end() ; ++it ) {
+      for( CommandLineParametersMap::mapped_type::const_iterator itP = it->second.begin() ; itP != it->second.end() ; ++itP ) {
+	h = hash( it->first + '\0' + itP->first + '\0' + itP->second + '\0', h ) ;
+      }
+    }
+
+    std::stringstream name ;
+    name << _cacheDir << "/marlin_steering_" << std::hex << std::setw(16) << std::setfill('0') << h << ".cache" ;
+    return name.str() ;
+  }
+
+
+  void CachedXMLParser::parse() {
+
+    const std::string cacheFile = cacheFileName() ;
+
+    _fromCache = readCache( cacheFile ) ;
+
+    if( _fromCache ) {
+      std::cout << "<!-- steering parameters read from cache file " << cacheFile << " -->" << std::endl ;
+      return ;
+    }
+
+    parseXML() ;
+    writeCache( cacheFile ) ;
+  }
+
+
+  void CachedXMLParser::parseXML() const {
+
+    _parser.reset( new XMLParser( _fileName ) ) ;
+    _parser->setCmdLineParameters( _cmdlineparams ) ;
+    _parser->parse() ;
+
+    _map.clear() ;
+  }
+
+
+  std::shared_ptr<StringParameters> CachedXMLParser::getParameters( const std::string& sectionName ) const {
+
+    if( _parser )
+      return _parser->getParameters( sectionName ) ;
+
+    StringParametersMap::const_iterator it = _map.find( sectionName ) ;
+
+    return ( it != _map.end() ? it->second : std::shared_ptr<StringParameters>() ) ;
+  }
+
+
+  void CachedXMLParser::write( const std::string& fname ) const {
+
+    if( ! _parser )
+      parseXML() ;
+
+    _parser->write( fname ) ;
+  }
+
+
+  bool CachedXMLParser::readCache( const std::string& cacheFile ) {
+
+    std::ifstream in( cacheFile.c_str(), std::ios::binary ) ;
+
+    if( ! in )
+      return false ;
+
+    char magic[8] ;
+    uint64_t version = 0 , n = 0 ;
+
+    if( ! in.read( magic, 8 ) || std::string( magic, 8 ) != std::string( cacheMagic, 8 ) ||
+	! readInt( in, version ) || version != cacheVersion || ! readInt( in, n ) )
+      return false ;
+
+    // the steering file and all included files have to be unchanged
+    for( uint64_t i=0 ; i < n ; ++i ) {
+
+      std::string file ;
+      uint64_t h = 0 ;
+
+      if( ! readString( in, file ) || ! readInt( in, h ) )
+	return false ;
+
+      bool ok ;
+      std::string content = readFile( file, ok ) ;
+
+      if( ! ok || hash( content ) != h )
+	return false ;
+    }
+
+    StringParametersMap map ;
+
+    if( ! readInt( in, n ) )
+      return false ;
+
+    for( uint64_t i=0 ; i < n ; ++i ) {
+
+      std::string section ;
+      uint64_t nKeys = 0 ;
+
+      if( ! readString( in, section ) || ! readInt( in, nKeys ) )
+	return false ;
+
+      std::shared_ptr<StringParameters> params = std::make_shared<StringParameters>() ;
+
+      for( uint64_t k=0 ; k < nKeys ; ++k ) {
+
+	std::string key ;
+	uint64_t nVals = 0 ;
+
+	if( ! readString( in, key ) || ! readInt( in, nVals ) )
+	  return false ;
+
+	StringVec vals( nVals ) ;
+
+	for( uint64_t v=0 ; v < nVals ; ++v ) {
+	  if( ! readString( in, vals[v] ) )
+	    return false ;
+	}
+	params->add( key, vals ) ;
+      }
+      map[ section ] = params ;
+    }
+
+    _map.swap( map ) ;
+    return true ;
+  }
+
+
+  void CachedXMLParser::writeCache( const std::string& cacheFile ) const {
+
+    // write to a temporary file of this job and rename it - other jobs might read or write the cache
+    std::string tmpName = cacheFile + ".XXXXXX" ;
+    const int fd = mkstemp( &tmpName[0] ) ;
+
+    if( fd < 0 ) {
+      std::cout << "<!-- WARNING: can't write steering cache file " << cacheFile << " -->" << std::endl ;
+      return ;
+    }
+
+    // mkstemp() creates the file readable only for the user - the cache is shared
+    fchmod( fd, 0644 ) ;
+    close( fd ) ;
+
+    std::ofstream out( tmpName.c_str(), std::ios::binary ) ;
+
+    if( ! out ) {
+      std::cout << "<!-- WARNING: can't write steering cache file " << cacheFile << " -->" << std::endl ;
+      std::remove( tmpName.c_str() ) ;
+      return ;
+    }
+
+    out.write( cacheMagic, 8 ) ;
+    writeInt( out, cacheVersion ) ;
+
+    std::vector<std::string> files( 1, _fileName ) ;
+    files.insert( files.end(), _parser->getIncludedFiles().begin(), _parser->getIncludedFiles().end() ) ;
+
+    writeInt( out, files.size() ) ;
+
+    for( unsigned i=0 ; i < files.size() ; ++i ) {
+      bool ok ;
+      writeString( out, files[i] ) ;
+      writeInt( out, hash( readFile( files[i], ok ) ) ) ;
+    }
+
+    const StringParametersMap& map = _parser->getParametersMap() ;
+
+    uint64_t nSections = 0 ;
+    for( StringParametersMap::const_iterator it = map.begin() ; it != map.end() ; ++it )
+      if( it->second )
+	++nSections ;
+
+    writeInt( out, nSections ) ;
+
+    for( StringParametersMap::const_iterator it = map.begin() ; it != map.end() ; ++it ) {
+
+      if( ! it->second )
+	continue ;
+
+      writeString( out, it->first ) ;
+
+      StringVec keys ;
+      it->second->getStringKeys( keys ) ;
+
+      writeInt( out, keys.size() ) ;
+
+      for( unsigned k=0 ; k < keys.size() ; ++k ) {
+
+	StringVec vals ;
+	it->second->getStringVals( keys[k], vals ) ;
+
+	writeString( out, keys[k] ) ;
+	writeInt( out, vals.size() ) ;
+
+	for( unsigned v=0 ; v < vals.size() ; ++v )
+	  writeString( out, vals[v] ) ;
+      }
+    }
+    out.close() ;
+
+    if( ! out || std::rename( tmpName.c_str(), cacheFile.c_str() ) != 0 ) {
+      std::remove( tmpName.c_str() ) ;
+      std::cout << "<!-- WARNING: can't write steering cache file " << cacheFile << " -->" << std::endl ;
+    }
+  }
+
+}
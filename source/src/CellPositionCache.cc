@@ -0,0 +1,175 @@
+#include "marlin/CellPositionCache.h"
+#include "marlin/Exceptions.h"
+#include "marlin/PipelineContext.h"
+#include "marlin/ResourceService.h"
+
+#include "streamlog/streamlog.h"
+
+#include <thread>
+
+namespace marlin{
+
+  namespace {
+
+    // shard from the well mixed bits of the cellID
+    inline unsigned shardOf( uint64_t cellID, unsigned nShards ) {
+      cellID ^= cellID >> 33 ;
+      cellID *= 0xff51afd7ed558ccdULL ;
+      cellID ^= cellID >> 33 ;
+      return cellID % nShards ;
+    }
+  }
+
+
+  std::shared_ptr<const CellPositionCache> CellPositionCache::get( const std::string& name, Calculator calc ) {
+    return get( name, calc, DenseIndex(), 0 ) ;
+  }
+
+
+  std::shared_ptr<const CellPositionCache> CellPositionCache::get( const std::string& name, Calculator calc,
+								   DenseIndex index, size_t size ) {
+
+    PipelineContext* ctx = PipelineContext::current() ;
+
+    return ctx->resources()->get<CellPositionCache>( "CellPositionCache:" + name, [&](){
+	return new CellPositionCache( name, ctx->GEAR(), calc, index, size ) ;
+      } ) ;
+  }
+
+
+  CellPositionCache::CellPositionCache( const std::string& name, const gear::GearMgr* gear, Calculator calc,
+					DenseIndex index, size_t denseSize ) :
+    _name( name ), _gear( gear ), _calc( calc ), _denseIndex( index ), _denseSize( index ? denseSize : 0 ) {
+
+    if( _denseSize > 0 ) {
+
+      _dense.resize( _denseSize ) ;
+      _denseState.reset( new std::atomic<unsigned char>[ _denseSize ] ) ;
+
+      for( size_t i=0 ; i < _denseSize ; ++i )
+	_denseState[i].store( 0, std::memory_order_relaxed ) ;
+    }
+  }
+
+
+  CellPositionCache::~CellPositionCache() {
+
+    const uint64_t h = hits() ;
+    const uint64_t m = misses() ;
+
+    streamlog_out( MESSAGE ) << " CellPositionCache " << _name << " : " << m << " cells computed, "
+			     << h << " cached lookups - hit rate "
+			     << ( h + m > 0 ? 100. * h / ( h + m ) : 0. ) << " %" << std::endl ;
+  }
+
+
+  CellInfo CellPositionCache::compute( uint64_t cellID ) const {
+
+    if( _gear == 0 )
+      throw Exception( "CellPositionCache " + _name + ": no GEAR geometry" ) ;
+
+    return _calc( cellID, *_gear ) ;
+  }
+
+
+  const CellInfo& CellPositionCache::lookup( uint64_t cellID ) const {
+
+    if( _denseSize > 0 ) {
+
+      const size_t i = _denseIndex( cellID ) ;
+
+      if( i < _denseSize ) {
+
+	if( _denseState[i].load( std::memory_order_acquire ) == 2 ) {
+	  _denseHits.fetch_add( 1, std::memory_order_relaxed ) ;
+	  return _dense[i] ;
+	}
+
+	unsigned char empty = 0 ;
+
+	if( _denseState[i].compare_exchange_strong( empty, 1, std::memory_order_acq_rel ) ) {
+
+	  try{
+	    _dense[i] = compute( cellID ) ;
+	  }
+	  catch(...) {
+	    _denseState[i].store( 0, std::memory_order_release ) ;
+	    throw ;
+	  }
+	  _denseState[i].store( 2, std::memory_order_release ) ;
+	  _denseMisses.fetch_add( 1, std::memory_order_relaxed ) ;
+	  return _dense[i] ;
+	}
+
+	// computed by another thread
+	while( _denseState[i].load( std::memory_order_acquire ) != 2 ) {
+
+	  if( _denseState[i].load( std::memory_order_acquire ) == 0 )
+	    return lookup( cellID ) ;
+
+	  std::this_thread::yield() ;
+	}
+	_denseHits.fetch_add( 1, std::memory_order_relaxed ) ;
+	return _dense[i] ;
+      }
+    }
+
+    Shard& shard = _shards[ shardOf( cellID, nShards ) ] ;
+    {
+      std::lock_guard<std::mutex> lock( shard.mutex ) ;
+
+      std::unordered_map< uint64_t, CellInfo >::const_iterator it = shard.cells.find( cellID ) ;
+
+      if( it != shard.cells.end() ) {
+	shard.hits.fetch_add( 1, std::memory_order_relaxed ) ;
+	return it->second ;
+      }
+    }
+
+    // computed outside the lock - the first thread to insert wins
+    const CellInfo info = compute( cellID ) ;
+
+    std::lock_guard<std::mutex> lock( shard.mutex ) ;
+
+    std::pair< std::unordered_map< uint64_t, CellInfo >::iterator, bool > r = shard.cells.emplace( cellID, info ) ;
+
+    if( r.second )
+      shard.misses.fetch_add( 1, std::memory_order_relaxed ) ;
+    else
+      shard.hits.fetch_add( 1, std::memory_order_relaxed ) ;
+
+    return r.first->second ;
+  }
+
+
+  void CellPositionCache::lookup( const uint64_t* cellIDs, size_t n, float* x, float* y, float* z ) const {
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const CellInfo& info = lookup( cellIDs[i] ) ;
+
+      x[i] = info.position[0] ;
+      y[i] = info.position[1] ;
+      z[i] = info.position[2] ;
+    }
+  }
+
+
+  uint64_t CellPositionCache::hits() const {
+
+    uint64_t n = _denseHits.load() ;
+    for( unsigned s=0 ; s < nShards ; ++s )
+      n += _shards[s].hits.load() ;
+    return n ;
+  }
+
+
+  uint64_t CellPositionCache::misses() const {
+
+    uint64_t n = _denseMisses.load() ;
+    for( unsigned s=0 ; s < nShards ; ++s )
+      n += _shards[s].misses.load() ;
+    return n ;
+  }
+
+}
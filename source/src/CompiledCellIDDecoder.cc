@@ -0,0 +1,110 @@
+#include "marlin/CompiledCellIDDecoder.h"
+#include "marlin/Exceptions.h"
+
+#include "lcio.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCParameters.h"
+#include "UTIL/BitField64.h"
+
+#include <map>
+#include <mutex>
+
+namespace marlin{
+
+  std::shared_ptr<const CompiledCellIDDecoder> CompiledCellIDDecoder::get( const std::string& encoding ) {
+
+    // decoders of all pipelines - they only depend on the encoding string
+    static std::mutex mutex ;
+    static std::map< std::string, std::shared_ptr<const CompiledCellIDDecoder> > decoders ;
+
+    std::lock_guard<std::mutex> lock( mutex ) ;
+
+    std::shared_ptr<const CompiledCellIDDecoder>& decoder = decoders[ encoding ] ;
+
+    if( ! decoder )
+      decoder = std::make_shared<const CompiledCellIDDecoder>( encoding ) ;
+
+    return decoder ;
+  }
+
+
+  std::shared_ptr<const CompiledCellIDDecoder> CompiledCellIDDecoder::get( const EVENT::LCCollection* col ) {
+
+    const std::string& encoding = col->getParameters().getStringVal( lcio::LCIO::CELLIDENCODING ) ;
+
+    if( encoding.empty() )
+      throw Exception( "CompiledCellIDDecoder: collection has no CellIDEncoding" ) ;
+
+    return get( encoding ) ;
+  }
+
+
+  CompiledCellIDDecoder::CompiledCellIDDecoder( const std::string& encoding ) : _encoding( encoding ) {
+
+    // the encoding is parsed by LCIO - only the field layout is kept
+    try{
+
+      UTIL::BitField64 bf( encoding ) ;
+
+      _fields.resize( bf.size() ) ;
+
+      for( size_t i=0 ; i < bf.size() ; ++i ) {
+
+	const UTIL::BitFieldValue& v = bf[i] ;
+
+	_fields[i].name = v.name() ;
+	_fields[i].offset = v.offset() ;
+	_fields[i].width = v.width() ;
+	_fields[i].isSigned = v.isSigned() ;
+	_fields[i].mask = v.mask() ;
+      }
+    }
+    catch( lcio::Exception& e ) {
+      throw Exception( "CompiledCellIDDecoder: invalid encoding " + encoding + " : " + e.what() ) ;
+    }
+  }
+
+
+  size_t CompiledCellIDDecoder::index( const std::string& name ) const {
+
+    for( size_t i=0 ; i < _fields.size() ; ++i ) {
+      if( _fields[i].name == name )
+	return i ;
+    }
+    throw Exception( "CompiledCellIDDecoder: no field " + name + " in encoding " + _encoding ) ;
+  }
+
+
+  void CompiledCellIDDecoder::decode( const uint64_t* cellIDs, size_t n, size_t i, int* out ) const {
+
+    const uint64_t mask = _fields[i].mask ;
+    const unsigned offset = _fields[i].offset ;
+    const unsigned width = _fields[i].width ;
+
+    // branch free loops for the compiler to vectorize
+    if( _fields[i].isSigned ) {
+
+      const unsigned shift = 64 - width ;
+
+      for( size_t k=0 ; k < n ; ++k )
+	out[k] = int( int64_t( ( ( cellIDs[k] & mask ) >> offset ) << shift ) >> shift ) ;
+    }
+    else {
+
+      for( size_t k=0 ; k < n ; ++k )
+	out[k] = int( ( cellIDs[k] & mask ) >> offset ) ;
+    }
+  }
+
+
+  void CompiledCellIDDecoder::decode( const uint64_t* cellIDs, size_t n, std::vector< std::vector<int> >& out ) const {
+
+    out.resize( _fields.size() ) ;
+
+    for( size_t i=0 ; i < _fields.size() ; ++i ) {
+      out[i].resize( n ) ;
+      decode( cellIDs, n, i, out[i].data() ) ;
+    }
+  }
+
+}
@@ -0,0 +1,76 @@
+#include "marlin/EventDataService.h"
+
+namespace marlin{
+
+  std::shared_ptr<EventDataService::Entry> EventDataService::entry( const EVENT::LCEvent* evt, const std::string& key,
+								      const std::type_info& type ) {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    std::shared_ptr<Entry>& e = _events[ evt ][ key ] ;
+
+    if( ! e ) {
+      e = std::make_shared<Entry>( type ) ;
+    }
+    else if( e->type != std::type_index( type ) ) {
+      throw Exception( std::string("EventDataService: event data ") + key
+		       + " already created with a different type" ) ;
+    }
+    return e ;
+  }
+
+
+  bool EventDataService::exists( const EVENT::LCEvent* evt, const std::string& key ) const {
+
+    std::shared_ptr<Entry> e ;
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+
+      auto itE = _events.find( evt ) ;
+      if( itE == _events.end() )
+	return false ;
+
+      auto it = itE->second.find( key ) ;
+      if( it == itE->second.end() )
+	return false ;
+      e = it->second ;
+    }
+    std::lock_guard<std::mutex> lock( e->mutex ) ;
+    return bool( e->data ) ;
+  }
+
+
+  void EventDataService::invalidate( const EVENT::LCEvent* evt, const std::string& key ) {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    auto itE = _events.find( evt ) ;
+    if( itE != _events.end() )
+      itE->second.erase( key ) ;
+  }
+
+
+  void EventDataService::endEvent( const EVENT::LCEvent* evt ) {
+
+    // the data is deleted outside the lock
+    EntryMap entries ;
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+
+      auto itE = _events.find( evt ) ;
+      if( itE == _events.end() )
+	return ;
+
+      entries.swap( itE->second ) ;
+      _events.erase( itE ) ;
+    }
+  }
+
+
+  void EventDataService::clear() {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    _events.clear() ;
+  }
+
+}
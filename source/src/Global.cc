@@ -1,6 +1,8 @@
 #include "marlin/Global.h"
 #include "marlin/StringParameters.h"
 #include "marlin/ProcessorEventSeeder.h"
+#include "marlin/ResourceService.h"
+#include "marlin/EventDataService.h"
 
 namespace marlin{
   
@@ -12,4 +14,8 @@ namespace marlin{
 
   ProcessorEventSeeder* Global::EVENTSEEDER = 0 ;
 
+  ResourceService* Global::RESOURCES = 0 ;
+
+  EventDataService* Global::EVENTDATA = 0 ;
+
 }
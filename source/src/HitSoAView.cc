@@ -0,0 +1,103 @@
+#include "marlin/HitSoAView.h"
+#include "marlin/EventDataService.h"
+#include "marlin/Exceptions.h"
+#include "marlin/PipelineContext.h"
+
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/CalorimeterHit.h"
+#include "EVENT/TrackerHit.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace marlin{
+
+  namespace {
+
+    inline uint64_t cellID64( int cellID0, int cellID1 ) {
+      return uint64_t( uint32_t( cellID0 ) ) | ( uint64_t( uint32_t( cellID1 ) ) << 32 ) ;
+    }
+  }
+
+
+  std::shared_ptr<const HitSoAView> HitSoAView::get( EVENT::LCEvent* evt, const std::string& colName ) {
+
+    return PipelineContext::current()->eventData()->get<HitSoAView>( evt, "HitSoAView:" + colName,
+								     [&](){ return new HitSoAView( evt->getCollection( colName ) ) ; } ) ;
+  }
+
+
+  void HitSoAView::AlignedDelete::operator()( float* p ) const {
+    free( p ) ;
+  }
+
+
+  HitSoAView::HitSoAView( const EVENT::LCCollection* col ) :
+    _size( col->getNumberOfElements() ) {
+
+    const std::string& type = col->getTypeName() ;
+
+    _calorimeterHits = ( type == lcio::LCIO::CALORIMETERHIT ) ;
+
+    if( ! _calorimeterHits && type != lcio::LCIO::TRACKERHIT && type != lcio::LCIO::TRACKERHITPLANE
+	&& type != lcio::LCIO::TRACKERHITZCYLINDER )
+      throw Exception( "HitSoAView: collection of type " + type + " is not a hit collection" ) ;
+
+    const size_t perBlock = alignment / sizeof( float ) ;
+    _stride = ( _size + perBlock - 1 ) / perBlock * perBlock ;
+
+    void* mem = nullptr ;
+    if( posix_memalign( &mem, alignment, ( 5 * _stride + 1 ) * sizeof( float ) ) != 0 )
+      throw std::bad_alloc() ;
+    _floats.reset( static_cast<float*>( mem ) ) ;
+
+    float* x = _floats.get() ;
+    float* y = x + _stride ;
+    float* z = y + _stride ;
+    float* e = z + _stride ;
+    float* t = e + _stride ;
+
+    _cellIDs.resize( _size ) ;
+    _objects.resize( _size ) ;
+
+    // the type is checked once for the collection - no dynamic_cast per hit
+    if( _calorimeterHits ) {
+
+      for( size_t i=0 ; i < _size ; ++i ) {
+
+	EVENT::CalorimeterHit* hit = static_cast<EVENT::CalorimeterHit*>( col->getElementAt( i ) ) ;
+	const float* pos = hit->getPosition() ;
+
+	x[i] = pos[0] ;
+	y[i] = pos[1] ;
+	z[i] = pos[2] ;
+	e[i] = hit->getEnergy() ;
+	t[i] = hit->getTime() ;
+	_cellIDs[i] = cellID64( hit->getCellID0(), hit->getCellID1() ) ;
+	_objects[i] = hit ;
+      }
+    }
+    else {
+
+      for( size_t i=0 ; i < _size ; ++i ) {
+
+	EVENT::TrackerHit* hit = static_cast<EVENT::TrackerHit*>( col->getElementAt( i ) ) ;
+	const double* pos = hit->getPosition() ;
+
+	x[i] = pos[0] ;
+	y[i] = pos[1] ;
+	z[i] = pos[2] ;
+	e[i] = hit->getEDep() ;
+	t[i] = hit->getTime() ;
+	_cellIDs[i] = cellID64( hit->getCellID0(), hit->getCellID1() ) ;
+	_objects[i] = hit ;
+      }
+    }
+
+    // padding of the arrays
+    for( size_t i=_size ; i < _stride ; ++i )
+      x[i] = y[i] = z[i] = e[i] = t[i] = 0.f ;
+  }
+
+}
@@ -0,0 +1,364 @@
+#include "marlin/JobServer.h"
+
+#include "lcio.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace marlin{
+
+  namespace {
+
+    // frames sent from the server to the client
+    const char outputFrame = 'O' ;
+    const char exitFrame   = 'X' ;
+
+    // milliseconds between reaping finished connection handlers while idle
+    const int reapInterval = 1000 ;
+
+    bool writeAll( int fd, const void* data, size_t n ) {
+      const char* p = static_cast<const char*>( data ) ;
+      while( n > 0 ) {
+	ssize_t w = send( fd, p, n, MSG_NOSIGNAL ) ;
+	if( w < 0 && errno == EINTR )
+	  continue ;
+	if( w <= 0 )
+	  return false ;
+	p += w ;
+	n -= w ;
+      }
+      return true ;
+    }
+
+    bool readAll( int fd, void* data, size_t n ) {
+      char* p = static_cast<char*>( data ) ;
+      while( n > 0 ) {
+	ssize_t r = read( fd, p, n ) ;
+	if( r < 0 && errno == EINTR )
+	  continue ;
+	if( r <= 0 )
+	  return false ;
+	p += r ;
+	n -= r ;
+      }
+      return true ;
+    }
+
+    bool writeString( int fd, const std::string& s ) {
+      uint32_t n = s.size() ;
+      return writeAll( fd, &n, sizeof( n ) ) && writeAll( fd, s.data(), n ) ;
+    }
+
+    bool readString( int fd, std::string& s ) {
+      uint32_t n = 0 ;
+      if( ! readAll( fd, &n, sizeof( n ) ) || n > ( 1u << 24 ) )
+	return false ;
+      s.resize( n ) ;
+      return n == 0 || readAll( fd, &s[0], n ) ;
+    }
+
+    bool writeFrame( int fd, char type, const void* data, uint32_t n ) {
+      return writeAll( fd, &type, 1 ) && writeAll( fd, &n, sizeof( n ) ) && writeAll( fd, data, n ) ;
+    }
+
+    sockaddr_un socketAddress( const std::string& socketName ) {
+
+      sockaddr_un addr ;
+      std::memset( &addr, 0, sizeof( addr ) ) ;
+      addr.sun_family = AF_UNIX ;
+
+      if( socketName.size() >= sizeof( addr.sun_path ) )
+	throw lcio::Exception( std::string( "JobServer: socket name too long: " ) + socketName ) ;
+
+      std::strncpy( addr.sun_path, socketName.c_str(), sizeof( addr.sun_path ) - 1 ) ;
+      return addr ;
+    }
+
+    /** The user id of the process on the other end of the connection - false if unknown */
+    bool peerUid( int fd, uid_t& uid ) {
+#ifdef SO_PEERCRED
+      ucred cred ;
+      socklen_t len = sizeof( cred ) ;
+      if( getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &len ) != 0 )
+	return false ;
+      uid = cred.uid ;
+      return true ;
+#else
+      gid_t gid ;
+      return getpeereid( fd, &uid, &gid ) == 0 ;
+#endif
+    }
+  }
+
+
+  JobServer::JobServer( const std::string& socketName, JobFunction job ) :
+    _socketName( socketName ), _job( job ) {
+  }
+
+  JobServer::~JobServer() {
+
+    if( _fd >= 0 ) {
+      close( _fd ) ;
+      unlink( _socketName.c_str() ) ;
+    }
+  }
+
+
+  void JobServer::run() {
+
+    sockaddr_un addr = socketAddress( _socketName ) ;
+
+    _fd = socket( AF_UNIX, SOCK_STREAM, 0 ) ;
+
+    if( _fd < 0 )
+      throw lcio::Exception( std::string( "JobServer: can't create socket: " ) + std::strerror( errno ) ) ;
+
+    // remove the socket of a previous server only if no server accepts connections on it
+    struct stat st ;
+
+    if( lstat( _socketName.c_str(), &st ) == 0 && S_ISSOCK( st.st_mode ) ) {
+
+      int probe = socket( AF_UNIX, SOCK_STREAM, 0 ) ;
+
+      if( probe >= 0 ) {
+
+	const bool running = ( connect( probe, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) ) == 0 ) ;
+	const int error = errno ;
+
+	close( probe ) ;
+
+	if( running ) {
+	  close( _fd ) ;
+	  _fd = -1 ;
+	  throw lcio::Exception( "JobServer: another server is running on socket " + _socketName ) ;
+	}
+
+	if( error == ECONNREFUSED )
+	  unlink( _socketName.c_str() ) ;
+      }
+    }
+
+    // only the user of the server can connect - the jobs run with the rights of this user
+    const mode_t mask = umask( 0177 ) ;
+
+    const bool bound = ( bind( _fd, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) ) == 0 ) ;
+    const int error = errno ;
+
+    umask( mask ) ;
+
+    if( ! bound || listen( _fd, 16 ) != 0 ) {
+
+      const std::string reason = std::strerror( bound ? errno : error ) ;
+
+      close( _fd ) ;
+      _fd = -1 ;
+
+      throw lcio::Exception( "JobServer: can't listen on socket " + _socketName + ": " + reason ) ;
+    }
+
+    std::cout << " ---- Marlin job server listening on " << _socketName << std::endl ;
+
+    while( true ) {
+
+      // reap the finished connection handlers - with a timeout also while no client connects
+      while( waitpid( -1, 0, WNOHANG ) > 0 ) ;
+
+      pollfd pfd ;
+      pfd.fd = _fd ;
+      pfd.events = POLLIN ;
+      pfd.revents = 0 ;
+
+      int ready = poll( &pfd, 1, reapInterval ) ;
+
+      if( ready < 0 && errno != EINTR )
+	throw lcio::Exception( std::string( "JobServer: poll failed: " ) + std::strerror( errno ) ) ;
+
+      if( ready <= 0 )
+	continue ;
+
+      int conn = accept( _fd, 0, 0 ) ;
+
+      if( conn < 0 ) {
+	if( errno == EINTR || errno == ECONNABORTED )
+	  continue ;
+	throw lcio::Exception( std::string( "JobServer: accept failed: " ) + std::strerror( errno ) ) ;
+      }
+
+      // the socket permissions are checked again for the connecting process
+      uid_t uid ;
+
+      if( ! peerUid( conn, uid ) || uid != getuid() ) {
+	std::cerr << " JobServer: rejected connection of another user" << std::endl ;
+	close( conn ) ;
+	continue ;
+      }
+
+      std::cout.flush() ;
+      std::cerr.flush() ;
+      std::fflush( 0 ) ;
+
+      pid_t pid = fork() ;
+
+      if( pid == 0 ) {
+	close( _fd ) ;
+	_fd = -1 ;
+	handleConnection( conn ) ;
+	_exit( 0 ) ;
+      }
+
+      if( pid < 0 )
+	std::cerr << " JobServer: fork failed: " << std::strerror( errno ) << std::endl ;
+
+      close( conn ) ;
+    }
+  }
+
+
+  void JobServer::handleConnection( int fd ) {
+
+    uint32_t n = 0 ;
+    std::string cwd ;
+
+    if( ! readAll( fd, &n, sizeof( n ) ) || n < 1 || n > 4096 || ! readString( fd, cwd ) )
+      return ;
+
+    std::vector<std::string> args( n - 1 ) ;
+
+    for( uint32_t i=0 ; i < args.size() ; ++i )
+      if( ! readString( fd, args[i] ) )
+	return ;
+
+    int out[2] ;
+    if( pipe( out ) != 0 )
+      return ;
+
+    pid_t pid = fork() ;
+
+    if( pid == 0 ) {
+
+      // the job process - output goes to the pipe
+      close( out[0] ) ;
+      close( fd ) ;
+      dup2( out[1], 1 ) ;
+      dup2( out[1], 2 ) ;
+      close( out[1] ) ;
+
+      int ret = 1 ;
+
+      if( chdir( cwd.c_str() ) != 0 ) {
+	std::cerr << " JobServer: can't change to directory " << cwd << std::endl ;
+      } else {
+	try{
+	  ret = _job( args ) ;
+	}
+	catch( std::exception& e ) {
+	  std::cerr << " JobServer: job failed with exception: " << e.what() << std::endl ;
+	}
+      }
+      std::cout.flush() ;
+      std::cerr.flush() ;
+      std::exit( ret ) ;
+    }
+
+    close( out[1] ) ;
+
+    if( pid < 0 ) {
+      close( out[0] ) ;
+      int32_t ret = 1 ;
+      writeFrame( fd, exitFrame, &ret, sizeof( ret ) ) ;
+      return ;
+    }
+
+    // stream the output back to the client
+    char buffer[65536] ;
+    bool connected = true ;
+
+    while( true ) {
+      ssize_t r = read( out[0], buffer, sizeof( buffer ) ) ;
+      if( r < 0 && errno == EINTR )
+	continue ;
+      if( r <= 0 )
+	break ;
+      if( connected && ! writeFrame( fd, outputFrame, buffer, r ) ) {
+	// client gone - the job gets SIGPIPE on its next output
+	connected = false ;
+	break ;
+      }
+    }
+    close( out[0] ) ;
+
+    int status = 0 ;
+    while( waitpid( pid, &status, 0 ) < 0 && errno == EINTR ) ;
+
+    int32_t ret = WIFEXITED( status ) ? WEXITSTATUS( status ) : 128 + WTERMSIG( status ) ;
+
+    if( connected )
+      writeFrame( fd, exitFrame, &ret, sizeof( ret ) ) ;
+
+    close( fd ) ;
+  }
+
+
+  int JobServer::submit( const std::string& socketName, const std::vector<std::string>& args,
+			 const std::string& cwd ) {
+
+    sockaddr_un addr = socketAddress( socketName ) ;
+
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 ) ;
+
+    if( fd < 0 || connect( fd, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) ) != 0 ) {
+      std::cerr << " JobServer: can't connect to Marlin server on " << socketName << ": "
+		<< std::strerror( errno ) << std::endl ;
+      if( fd >= 0 )
+	close( fd ) ;
+      return 1 ;
+    }
+
+    uint32_t n = args.size() + 1 ;
+    bool ok = writeAll( fd, &n, sizeof( n ) ) && writeString( fd, cwd ) ;
+
+    for( unsigned i=0 ; ok && i < args.size() ; ++i )
+      ok = writeString( fd, args[i] ) ;
+
+    std::vector<char> buffer ;
+
+    while( ok ) {
+
+      char type ;
+      uint32_t len = 0 ;
+
+      if( ! readAll( fd, &type, 1 ) || ! readAll( fd, &len, sizeof( len ) ) )
+	break ;
+
+      buffer.resize( len ) ;
+
+      if( len > 0 && ! readAll( fd, &buffer[0], len ) )
+	break ;
+
+      if( type == exitFrame && len == sizeof( int32_t ) ) {
+	int32_t ret ;
+	std::memcpy( &ret, &buffer[0], sizeof( ret ) ) ;
+	close( fd ) ;
+	return ret ;
+      }
+
+      if( type == outputFrame && len > 0 )
+	std::cout.write( &buffer[0], len ).flush() ;
+    }
+
+    close( fd ) ;
+    std::cerr << " JobServer: connection to Marlin server on " << socketName << " lost" << std::endl ;
+    return 1 ;
+  }
+
+}
@@ -5,6 +5,11 @@
 #include "UTIL/LCTOOLS.h"
 #include "EVENT/LCCollection.h"
 #include "IMPL/LCCollectionVec.h"
+#include "IO/LCReader.h"
+#include "IO/LCRunListener.h"
+#include "IO/LCEventListener.h"
+#include "marlin/PipelineContext.h"
+#include "marlin/ProcessorMgr.h"
 
 
 #if LCIO_VERSION_GE(1,7)
@@ -15,6 +20,10 @@
 
 #include <algorithm>
 #include <bitset>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
 
 namespace marlin{
   
@@ -149,6 +158,9 @@ void LCIOOutputProcessor::processRunHeader( LCRunHeader* run) {
 
   _lcWrt->writeRunHeader( run ) ;
 
+  if( _workerIndex )
+    *_workerIndex << "R " << context()->processorMgr()->inputEventIndex() << "\n" ;
+
   _nRun++ ;
 } 
 
@@ -266,6 +278,9 @@ void LCIOOutputProcessor::processEvent( LCEvent * evt ) {
 
   _lcWrt->writeEvent( evt ) ;
 
+  if( _workerIndex )
+    *_workerIndex << "E " << context()->processorMgr()->inputEventIndex() << "\n" ;
+
   // revert subset flag - if any 
   for( SubSetVec::iterator sIt = _subSets.begin() ; 
        sIt != _subSets.end() ;  ++sIt  ) {
@@ -291,6 +306,159 @@ void LCIOOutputProcessor::end(){
   delete _lcWrt;
   _lcWrt = nullptr;
 
+  _workerIndex.reset() ;
+
 }
 
+
+  std::string LCIOOutputProcessor::workerFileName( int workerID ) const {
+
+    std::string base( _lcioOutputFile ) ;
+
+    if( base.size() > 6 && base.substr( base.size() - 6 ) == ".slcio" )
+      base.resize( base.size() - 6 ) ;
+
+    std::stringstream name ;
+    name << base << "_worker" << workerID << ".slcio" ;
+    return name.str() ;
+  }
+
+
+  std::string LCIOOutputProcessor::workerIndexFileName( int workerID ) const {
+    return workerFileName( workerID ) + ".index" ;
+  }
+
+
+  void LCIOOutputProcessor::workerStarted( int workerID ) {
+
+    // the writer opened in init() belongs to the main process - it is neither used nor closed here
+    _lcWrt = LCFactory::getInstance()->createLCWriter() ;
+    _lcWrt->setCompressionLevel( _compressionLevel ) ;
+    _lcWrt->open( workerFileName( workerID ) , LCIO::WRITE_NEW ) ;
+
+    // the input position of every record written, for merging in input order
+    _workerIndex.reset( new std::ofstream( workerIndexFileName( workerID ).c_str() ) ) ;
+  }
+
+
+  void LCIOOutputProcessor::mergeWorkerOutput( int nWorkers ) {
+
+    // the records of all workers sorted by their position in the input - run headers before
+    // the events at the same position
+    struct Record {
+      long index ;
+      int type ;      // 0 run header, 1 event
+      int ordinal ;   // of run headers at the same position
+      int worker ;
+      bool operator<( const Record& o ) const {
+	if( index != o.index ) return index < o.index ;
+	if( type != o.type ) return type < o.type ;
+	if( ordinal != o.ordinal ) return ordinal < o.ordinal ;
+	return worker < o.worker ;
+      }
+    } ;
+
+    std::vector<Record> records ;
+    std::vector<LCReader*> runReaders( nWorkers, nullptr ) ;
+    std::vector<LCReader*> evtReaders( nWorkers, nullptr ) ;
+
+    for( int i=0 ; i < nWorkers ; ++i ) {
+
+      std::ifstream in( workerIndexFileName( i ).c_str() ) ;
+
+      if( ! in ) {
+	streamlog_out( ERROR ) << "LCIOOutputProcessor::mergeWorkerOutput()  " << name() 
+			       << ": no index file " << workerIndexFileName( i ) << " - output of worker " << i << " lost" << std::endl ;
+	continue ;
+      }
+
+      std::string type ;
+      long index = 0 ;
+      long lastRunIndex = -1 ;
+      int ordinal = 0 ;
+
+      while( in >> type >> index ) {
+
+	Record r = { index, ( type == "R" ? 0 : 1 ), 0, i } ;
+
+	if( r.type == 0 ) {
+	  ordinal = ( index == lastRunIndex ? ordinal + 1 : 0 ) ;
+	  lastRunIndex = index ;
+	  r.ordinal = ordinal ;
+	}
+	records.push_back( r ) ;
+      }
+
+      try{
+	runReaders[i] = LCFactory::getInstance()->createLCReader() ;
+	runReaders[i]->open( workerFileName( i ) ) ;
+	evtReaders[i] = LCFactory::getInstance()->createLCReader() ;
+	evtReaders[i]->open( workerFileName( i ) ) ;
+      }
+      catch( lcio::Exception& e ) {
+	streamlog_out( ERROR ) << "LCIOOutputProcessor::mergeWorkerOutput()  " << name() 
+			       << ": can't open worker file " << workerFileName( i ) << " : " << e.what() << std::endl ;
+	delete runReaders[i] ;
+	delete evtReaders[i] ;
+	runReaders[i] = evtReaders[i] = nullptr ;
+      }
+    }
+
+    std::stable_sort( records.begin(), records.end() ) ;
+
+    // every worker writes the run headers - only the first copy is written
+    const Record* lastRun = nullptr ;
+
+    try{
+
+      for( unsigned k=0 ; k < records.size() ; ++k ) {
+
+	const Record& r = records[k] ;
+
+	if( runReaders[ r.worker ] == nullptr )
+	  continue ;
+
+	if( r.type == 0 ) {
+
+	  LCRunHeader* run = runReaders[ r.worker ]->readNextRunHeader() ;
+
+	  if( run != nullptr && ( lastRun == nullptr || lastRun->index != r.index || lastRun->ordinal != r.ordinal ) ) {
+	    _lcWrt->writeRunHeader( run ) ;
+	    ++_nRun ;
+	  }
+	  lastRun = &r ;
+	}
+	else {
+
+	  LCEvent* evt = evtReaders[ r.worker ]->readNextEvent() ;
+
+	  if( evt != nullptr ) {
+	    _lcWrt->writeEvent( evt ) ;
+	    ++_nEvt ;
+	  }
+	}
+      }
+    }
+    catch( lcio::Exception& e ) {
+      streamlog_out( ERROR ) << "LCIOOutputProcessor::mergeWorkerOutput()  " << name() 
+			     << ": can't merge worker files : " << e.what() << std::endl ;
+    }
+
+    for( int i=0 ; i < nWorkers ; ++i ) {
+
+      if( runReaders[i] == nullptr )
+	continue ;
+
+      runReaders[i]->close() ;
+      evtReaders[i]->close() ;
+      delete runReaders[i] ;
+      delete evtReaders[i] ;
+
+      std::remove( workerFileName( i ).c_str() ) ;
+      std::remove( workerIndexFileName( i ).c_str() ) ;
+    }
+
+    end() ;
+  }
+
 } // namespace marlin{
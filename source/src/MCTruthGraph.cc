@@ -0,0 +1,257 @@
+#include "marlin/MCTruthGraph.h"
+#include "marlin/EventDataService.h"
+#include "marlin/Exceptions.h"
+#include "marlin/PipelineContext.h"
+
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/MCParticle.h"
+
+#include <algorithm>
+
+namespace marlin{
+
+  std::shared_ptr<const MCTruthGraph> MCTruthGraph::get( EVENT::LCEvent* evt, const std::string& colName ) {
+
+    return PipelineContext::current()->eventData()->get<MCTruthGraph>( evt, "MCTruthGraph:" + colName,
+								       [&](){ return new MCTruthGraph( evt->getCollection( colName ) ) ; } ) ;
+  }
+
+
+  MCTruthGraph::MCTruthGraph( const EVENT::LCCollection* col ) {
+
+    if( col->getTypeName() != lcio::LCIO::MCPARTICLE )
+      throw Exception( "MCTruthGraph: collection of type " + col->getTypeName() + " is not an MCParticle collection" ) ;
+
+    const unsigned n = col->getNumberOfElements() ;
+
+    _particles.resize( n ) ;
+    _pdg.resize( n ) ;
+    _generatorStatus.resize( n ) ;
+    _lookup.resize( n ) ;
+
+    for( unsigned i=0 ; i < n ; ++i ) {
+
+      EVENT::MCParticle* mcp = static_cast<EVENT::MCParticle*>( col->getElementAt( i ) ) ;
+
+      _particles[i] = mcp ;
+      _pdg[i] = mcp->getPDG() ;
+      _generatorStatus[i] = mcp->getGeneratorStatus() ;
+      _lookup[i] = std::make_pair( mcp, i ) ;
+    }
+
+    std::sort( _lookup.begin(), _lookup.end() ) ;
+
+    // ---- CSR arrays - parents and daughters outside the collection are ignored
+    _parentStart.assign( n + 1, 0 ) ;
+    _daughterStart.assign( n + 1, 0 ) ;
+
+    for( unsigned i=0 ; i < n ; ++i ) {
+
+      const EVENT::MCParticleVec& parents = _particles[i]->getParents() ;
+
+      for( unsigned k=0 ; k < parents.size() ; ++k ) {
+
+	const unsigned p = index( parents[k] ) ;
+
+	if( p != npos )
+	  _parents.push_back( p ) ;
+      }
+      _parentStart[ i + 1 ] = _parents.size() ;
+
+      const EVENT::MCParticleVec& daughters = _particles[i]->getDaughters() ;
+
+      for( unsigned k=0 ; k < daughters.size() ; ++k ) {
+
+	const unsigned d = index( daughters[k] ) ;
+
+	if( d != npos )
+	  _daughters.push_back( d ) ;
+      }
+      _daughterStart[ i + 1 ] = _daughters.size() ;
+    }
+
+    // ---- topological order from the parent links
+    std::vector<unsigned> nParents( n ) ;
+    for( unsigned i=0 ; i < n ; ++i )
+      nParents[i] = _parentStart[ i + 1 ] - _parentStart[i] ;
+
+    std::vector<unsigned> children( _parents.size() ) ;
+    std::vector<unsigned> childStart( n + 1, 0 ) ;
+
+    for( unsigned k=0 ; k < _parents.size() ; ++k )
+      ++childStart[ _parents[k] + 1 ] ;
+    for( unsigned i=0 ; i < n ; ++i )
+      childStart[ i + 1 ] += childStart[i] ;
+    {
+      std::vector<unsigned> pos( childStart.begin(), childStart.end() - 1 ) ;
+      for( unsigned i=0 ; i < n ; ++i )
+	for( unsigned k = _parentStart[i] ; k < _parentStart[ i + 1 ] ; ++k )
+	  children[ pos[ _parents[k] ]++ ] = i ;
+    }
+
+    _order.reserve( n ) ;
+    for( unsigned i=0 ; i < n ; ++i )
+      if( nParents[i] == 0 )
+	_order.push_back( i ) ;
+
+    for( unsigned k=0 ; k < _order.size() ; ++k ) {
+
+      const unsigned p = _order[k] ;
+
+      for( unsigned c = childStart[p] ; c < childStart[ p + 1 ] ; ++c )
+	if( --nParents[ children[c] ] == 0 )
+	  _order.push_back( children[c] ) ;
+    }
+
+    if( _order.size() != n ) {
+
+      // inconsistent parent links (cycles) - the remaining particles are appended
+      std::vector<bool> done( n, false ) ;
+      for( unsigned k=0 ; k < _order.size() ; ++k )
+	done[ _order[k] ] = true ;
+      for( unsigned i=0 ; i < n ; ++i )
+	if( ! done[i] )
+	  _order.push_back( i ) ;
+    }
+
+    // ---- generation depth and ancestor bitsets in topological order
+    _depth.assign( n, 0 ) ;
+
+    if( n <= maxAncestorBits ) {
+      _words = ( n + 63 ) / 64 ;
+      _ancestorBits.assign( n * _words, 0 ) ;
+    }
+
+    for( unsigned k=0 ; k < n ; ++k ) {
+
+      const unsigned i = _order[k] ;
+      uint64_t* bits = ( _words > 0 ? &_ancestorBits[ i * _words ] : 0 ) ;
+
+      for( unsigned j = _parentStart[i] ; j < _parentStart[ i + 1 ] ; ++j ) {
+
+	const unsigned p = _parents[j] ;
+
+	_depth[i] = std::max( _depth[i], _depth[p] + 1 ) ;
+
+	if( bits != 0 ) {
+	  const uint64_t* parentBits = &_ancestorBits[ p * _words ] ;
+	  for( size_t w=0 ; w < _words ; ++w )
+	    bits[w] |= parentBits[w] ;
+	  bits[ p / 64 ] |= uint64_t(1) << ( p % 64 ) ;
+	}
+      }
+    }
+  }
+
+
+  unsigned MCTruthGraph::index( const EVENT::MCParticle* mcp ) const {
+
+    std::vector< std::pair<const EVENT::MCParticle*, unsigned> >::const_iterator it =
+      std::lower_bound( _lookup.begin(), _lookup.end(), std::make_pair( mcp, 0u ) ) ;
+
+    return ( it != _lookup.end() && it->first == mcp ? it->second : npos ) ;
+  }
+
+
+  bool MCTruthGraph::isAncestor( unsigned a, unsigned d ) const {
+
+    if( _words > 0 )
+      return ( _ancestorBits[ d * _words + a / 64 ] >> ( a % 64 ) ) & 1 ;
+
+    // an ancestor has a smaller depth - walk the parents up to that depth
+    std::vector<unsigned> stack( 1, d ) ;
+    std::vector<bool> visited( size(), false ) ;
+
+    while( ! stack.empty() ) {
+
+      const unsigned i = stack.back() ;
+      stack.pop_back() ;
+
+      for( unsigned j = _parentStart[i] ; j < _parentStart[ i + 1 ] ; ++j ) {
+
+	const unsigned p = _parents[j] ;
+
+	if( p == a )
+	  return true ;
+
+	if( ! visited[p] && _depth[p] > _depth[a] ) {
+	  visited[p] = true ;
+	  stack.push_back( p ) ;
+	}
+      }
+    }
+    return false ;
+  }
+
+
+  void MCTruthGraph::ancestors( unsigned i, std::vector<unsigned>& result ) const {
+
+    if( _words > 0 ) {
+
+      const uint64_t* bits = &_ancestorBits[ i * _words ] ;
+
+      for( size_t w=0 ; w < _words ; ++w ) {
+	for( uint64_t b = bits[w] ; b != 0 ; b &= b - 1 )
+	  result.push_back( w * 64 + __builtin_ctzll( b ) ) ;
+      }
+      return ;
+    }
+
+    std::vector<unsigned> stack( 1, i ) ;
+    std::vector<bool> visited( size(), false ) ;
+
+    while( ! stack.empty() ) {
+
+      const unsigned k = stack.back() ;
+      stack.pop_back() ;
+
+      for( unsigned j = _parentStart[k] ; j < _parentStart[ k + 1 ] ; ++j ) {
+	if( ! visited[ _parents[j] ] ) {
+	  visited[ _parents[j] ] = true ;
+	  result.push_back( _parents[j] ) ;
+	  stack.push_back( _parents[j] ) ;
+	}
+      }
+    }
+  }
+
+
+  void MCTruthGraph::stableDescendants( unsigned i, std::vector<unsigned>& result ) const {
+
+    std::vector<unsigned> stack( 1, i ) ;
+    std::vector<bool> visited( size(), false ) ;
+
+    while( ! stack.empty() ) {
+
+      const unsigned k = stack.back() ;
+      stack.pop_back() ;
+
+      for( unsigned j = _daughterStart[k] ; j < _daughterStart[ k + 1 ] ; ++j ) {
+
+	const unsigned d = _daughters[j] ;
+
+	if( visited[d] )
+	  continue ;
+
+	visited[d] = true ;
+
+	if( _generatorStatus[d] == 1 )
+	  result.push_back( d ) ;
+
+	stack.push_back( d ) ;
+      }
+    }
+  }
+
+
+  unsigned MCTruthGraph::primary( unsigned i ) const {
+
+    // the depth decreases along the first parents unless the links are inconsistent
+    for( size_t steps=0 ; _parentStart[ i + 1 ] > _parentStart[i] && steps < size() ; ++steps )
+      i = _parents[ _parentStart[i] ] ;
+
+    return i ;
+  }
+
+}
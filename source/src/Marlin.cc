@@ -18,6 +18,7 @@
 
 #include "marlin/Parser.h"
 #include "marlin/XMLParser.h"
+#include "marlin/CachedXMLParser.h"
 
 #include "marlin/Global.h"
 
@@ -29,16 +30,23 @@
 #include <string>
 #include <assert.h>
 #include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <cstring>
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <set>
 
 #include "gearimpl/Util.h"
 #include "gearxml/GearXML.h"
 #include "gearimpl/GearMgrImpl.h"
 
+#include "marlin/JobServer.h"
+#include "marlin/MultiProcessRunner.h"
 #include "marlin/ProcessorLoader.h"
+#include "marlin/StartupProfiler.h"
 
 #include "marlin/VerbosityLevels.h"
 #include "streamlog/streamlog.h"
@@ -53,8 +61,15 @@ void createProcessors( Parser&  parser ) ;
 void  createProcessors( const IParser&  parser) ;
 
 void listAvailableProcessors() ;
+void printStartupProfile() ;
+gear::GearMgr* preloadGearMgr( const std::string& gearFile ) ;
+gear::GearMgr* preloadedGearMgr( const std::string& gearFile ) ;
 void listAvailableProcessorsXML() ;
+void printXMLHeader() ;
 int printUsage() ;
+int runMarlin( int argc, char** argv, ProcessorLoader& loader ) ;
+int runServer( const std::string& socketName, const StringVec& gearFiles, ProcessorLoader& loader ) ;
+int runClient( int argc, char** argv ) ;
 
 
 // Handle user interruption
@@ -75,20 +90,23 @@ int main(int argc, char** argv ){
   // Register escape behaviour
   signal(SIGQUIT, userException);
 
+  // start the clock for the startup profile
+  StartupProfiler::instance() ;
+
   // ---- catch all uncaught exceptions in the end ...
   try{
  
+    // submit the job to a running Marlin server
+    if( argc > 1 && std::string(argv[1]) == "--client" ){
+        return runClient( argc, argv ) ;
+    }
     
     if( argc > 1 ){
         if( std::string(argv[1]) == "-x" ){
-            std::cout  << "<?xml version=\"1.0\" encoding=\"us-ascii\"?>" << std::endl
-                << "<!-- ?xml-stylesheet type=\"text/xsl\" href=\"http://ilcsoft.desy.de/marlin/marlin.xsl\"? -->" << std::endl
-                << "<!-- ?xml-stylesheet type=\"text/xsl\" href=\"marlin.xsl\"? -->" << std::endl << std::endl;
+            printXMLHeader() ;
         }
     }
 
-    //#ifndef MARLIN_NO_DLL
-
     //------ load shared libraries with processors ------
 
     StringVec libs ;
@@ -96,6 +114,8 @@ int main(int argc, char** argv ){
 
     std::string marlinProcs("") ;
 
+#ifndef MARLIN_NO_DLL
+
     char * var =  getenv("MARLIN_DLL" ) ;
 
     if( var != 0 ) {
@@ -105,17 +125,59 @@ int main(int argc, char** argv ){
             " - so no processors will be loaded. ! --> " << std::endl << std::endl ;
     }
 
+#else
+
+    // the processors are linked into this executable (MARLIN_ADD_STATIC_EXECUTABLE) 
+    std::cout << std::endl << "<!-- Marlin executable with statically linked processors"
+        " - MARLIN_DLL is ignored --> " << std::endl << std::endl ;
+
+#endif
+
     std::for_each( marlinProcs.begin(), marlinProcs.end(), tk1 ) ;
 
-    ProcessorLoader loader( libs.begin() , libs.end()  ) ;
+    // with a processor registry cache the libraries are only loaded for the processors used
+    char * cacheVar =  getenv("MARLIN_REGISTRY_CACHE" ) ;
+
+    std::unique_ptr<ProcessorLoader> loaderPtr( cacheVar != 0 && std::strlen( cacheVar ) > 0 ?
+                                                new ProcessorLoader( libs.begin() , libs.end() , cacheVar ) :
+                                                new ProcessorLoader( libs.begin() , libs.end() ) ) ;
+    ProcessorLoader& loader = *loaderPtr ;
+
     if( loader.failedLoading() ){
         return(1);
     }
 
     //------- end processor libs -------------------------
 
-    //#endif
+    if( argc > 1 && std::string(argv[1]) == "--server" ){
+
+        if( argc < 3 ){
+            std::cout << "  usage: Marlin --server socket [gear.xml ...]" << std::endl << std::endl ;
+            return(1) ;
+        }
+        return runServer( argv[2], StringVec( argv + 3, argv + argc ), loader ) ;
+    }
 
+    return runMarlin( argc, argv, loader ) ;
+
+  } catch( std::exception& e) {
+
+    std::cerr << " ***********************************************\n" 
+	      << " A runtime error occured - (uncaught exception):\n" 
+	      << "      " <<    e.what() << "\n"
+	      << " Marlin will have to be terminated, sorry.\n"  
+	      << " ***********************************************\n" 
+	      << std:: endl ; 
+
+    return 1 ;
+
+  }
+
+}
+
+/** Run Marlin with the given command line - the processor libraries are loaded with loader.
+ */
+int runMarlin( int argc, char** argv, ProcessorLoader& loader ){
 
     const char* steeringFileName = "none"  ;
 
@@ -180,6 +242,14 @@ int main(int argc, char** argv ){
     }
 
     cout << endl ;
+
+    // all options but running a steering file need all processors
+    if( ! loader.allLoaded() && ( argc < 2 || ( argv[1][0] == '-' && std::string(argv[1]) != "-n" ) ) ){
+        loader.loadAll() ;
+        if( loader.failedLoading() ){
+            return(1);
+        }
+    }
     
     bool dryRun(false);
 
@@ -265,6 +335,13 @@ int main(int argc, char** argv ){
                 + strlen(".xml") == filen.length() ) ) {  
         parser = std::unique_ptr<IParser> ( new Parser( steeringFileName ) );
 
+    } else if( getenv("MARLIN_STEERING_CACHE") != 0 && std::strlen( getenv("MARLIN_STEERING_CACHE") ) > 0 ) {
+
+        // fully resolved steering parameters are cached in this directory
+        parser = std::unique_ptr<IParser>( new CachedXMLParser( steeringFileName , getenv("MARLIN_STEERING_CACHE") ) ) ;
+
+        parser->setCmdLineParameters( cmdlineparams ) ;
+
     } else {
 
         parser = std::unique_ptr<IParser>( new XMLParser(steeringFileName) ) ;
@@ -297,6 +374,26 @@ int main(int argc, char** argv ){
       return(0) ;
     }
 
+    if( ! loader.allLoaded() ){
+
+      // load the libraries for the active processors only
+      std::set<std::string> types ;
+      StringVec activeProcessors ;
+      Global::parameters->getStringVals("ActiveProcessors" , activeProcessors ) ;
+
+      for( unsigned i=0 ; i < activeProcessors.size() ; ++i ){
+        std::shared_ptr<StringParameters> p = parser->getParameters( activeProcessors[i] ) ;
+        if( p != 0 )
+          types.insert( p->getStringVal("ProcessorType") ) ;
+      }
+
+      loader.loadForTypes( types ) ;
+
+      if( loader.failedLoading() ){
+        return(1);
+      }
+    }
+
     // //-----  register log level names with the logstream ---------
     streamlog::out.addLevelName<DEBUG>() ;
     streamlog::out.addLevelName<DEBUG0>() ;
@@ -351,21 +448,48 @@ int main(int argc, char** argv ){
 
     scope.setLevel( verbosity ) ;
 
+    StartupProfiler::Phase createPhase( "processors", "createProcessors" ) ;
+
     createProcessors( *parser ) ;
 
+    createPhase.stop() ;
+
 
     //#ifdef USE_GEAR
 
     std::string gearFile = Global::parameters->getStringVal("GearXMLFile" ) ;
+    bool gearPreloaded = false ;
 
     if( gearFile.size() > 0 ) {
       
-      gear::GearXML gearXML( gearFile ) ;
-      
-      Global::GEAR = gearXML.createGearMgr() ;
-      
-      streamlog_out( MESSAGE )  << " ---- instantiated  GEAR from file  " << gearFile  << std::endl 
-				<< *Global::GEAR << std::endl ;
+      StartupProfiler::Phase gearPhase( "gear", gearFile ) ;
+
+      // a job of the job server reuses the geometry preloaded by the server
+      Global::GEAR = preloadedGearMgr( gearFile ) ;
+      gearPreloaded = ( Global::GEAR != 0 ) ;
+
+      if( gearPreloaded ) {
+
+        streamlog_out( MESSAGE ) << " ---- reusing GEAR geometry preloaded from file  " << gearFile << std::endl ;
+      }
+      else {
+
+        gear::GearXML gearXML( gearFile ) ;
+
+        Global::GEAR = gearXML.createGearMgr() ;
+      }
+
+      gearPhase.stop() ;
+
+      streamlog_out( MESSAGE )  << " ---- instantiated  GEAR from file  " << gearFile  << std::endl ;
+
+      // the full geometry printout is long for large detectors - only on request
+      if( Global::parameters->getStringVal("PrintGearGeometry") == "true" ) {
+
+        StartupProfiler::Phase printPhase( "gear", "print geometry" ) ;
+
+        streamlog_out( MESSAGE ) << *Global::GEAR << std::endl ;
+      }
       
     } else {
 
@@ -375,12 +499,15 @@ int main(int argc, char** argv ){
 
     //#endif
 
+    int ret = 0 ;
+
     StringVec lcioInputFiles ; 
 
     if ( (Global::parameters->getStringVals("LCIOInputFiles" , lcioInputFiles ) ).size() == 0 ){
 
         int maxRecord = Global::parameters->getIntVal("MaxRecordNumber");
         ProcessorMgr::instance()->init() ; 
+        printStartupProfile() ;
         // fixme: pass maxRecord-1 (because of the runheader, which is generated)?
         ProcessorMgr::instance()->readDataSource(maxRecord) ; 
         ProcessorMgr::instance()->end() ; 
@@ -428,13 +555,49 @@ int main(int argc, char** argv ){
 #endif
 	} 
 
-        lcReader->registerLCRunListener( ProcessorMgr::instance() ) ; 
-        lcReader->registerLCEventListener( ProcessorMgr::instance() ) ; 
+        // multi-process mode: the workers are forked after init()
+        int nProcesses = Global::parameters->getIntVal("NumberOfProcesses") ;
+
+        std::unique_ptr<MultiProcessRunner> runner ;
+
+        if( nProcesses > 1 && ProcessorMgr::instance()->allowWorkerProcesses() ) {
+
+            int chunkSize = Global::parameters->getIntVal("EventChunkSize") ;
+
+            runner.reset( new MultiProcessRunner( nProcesses, chunkSize > 0 ? chunkSize : 10 , ProcessorMgr::instance() ) ) ;
+
+            lcReader->registerLCRunListener( runner.get() ) ; 
+            lcReader->registerLCEventListener( runner.get() ) ; 
+
+        } else {
+
+            if( nProcesses > 1 )
+                streamlog_out( WARNING ) << " ---- NumberOfProcesses ignored - running with a single process " << std::endl ;
+
+            lcReader->registerLCRunListener( ProcessorMgr::instance() ) ; 
+            lcReader->registerLCEventListener( ProcessorMgr::instance() ) ; 
+        }
 
         ProcessorMgr::instance()->init() ; 
+        printStartupProfile() ;
 
         bool rewind = true ;
 
+        // the main process waits for the workers and merges their output
+        if( runner && runner->start() < 0 ) {
+
+            if( ! runner->wait() ) {
+                streamlog_out( ERROR ) << " ---- not all worker processes finished successfully " << std::endl ;
+                ret = 1 ;
+            }
+
+            ProcessorMgr::instance()->endWorkers( runner->numberOfProcesses() ) ;
+
+            delete lcReader ;
+
+            rewind = false ;
+        }
+
         while( rewind ) {
 
             rewind = false ;
@@ -500,6 +663,9 @@ int main(int argc, char** argv ){
 
             if( !rewind ) {
 
+                if( runner ) 
+                    runner->finishWorker() ;
+
                 ProcessorMgr::instance()->end() ; 
 
                 delete lcReader ;
@@ -511,26 +677,76 @@ int main(int argc, char** argv ){
 
     //#ifdef USE_GEAR  
 
-    if(  Global::GEAR != 0 ) 
+    // preloaded geometries are owned by the cache of the job server
+    if(  Global::GEAR != 0 && ! gearPreloaded ) 
         delete Global::GEAR ; 
 
+    Global::GEAR = 0 ;
+
     //#endif  
 
+    return ret ;
+}
+
+/** Run the Marlin job server on the given socket: all processor libraries and the given
+ *  GEAR files are loaded once, every job runs in a fork of this process.
+ */
+int runServer( const std::string& socketName, const StringVec& gearFiles, ProcessorLoader& loader ){
+
+    if( ! loader.allLoaded() ){
+        loader.loadAll() ;
+    }
+    if( loader.failedLoading() ){
+        return(1);
+    }
+
+    // fill the geometry cache - inherited by the jobs
+    for( unsigned i=0 ; i < gearFiles.size() ; ++i ){
+        preloadGearMgr( gearFiles[i] ) ;
+        std::cout << " ---- preloaded GEAR from file " << gearFiles[i] << std::endl ;
+    }
+
+    JobServer server( socketName, [&loader]( std::vector<std::string>& args ){
+
+        // the startup of the job starts now
+        StartupProfiler::instance()->restart() ;
+
+        std::vector<char*> argv ;
+        for( unsigned i=0 ; i < args.size() ; ++i )
+            argv.push_back( &args[i][0] ) ;
+        argv.push_back( 0 ) ;
+
+        if( args.size() > 1 && args[1] == "-x" )
+            printXMLHeader() ;
+
+        return runMarlin( args.size(), &argv[0], loader ) ;
+    } ) ;
+
+    server.run() ;
+
     return 0 ;
+}
 
-  } catch( std::exception& e) {
+/** Submit the job given on the command line ( Marlin --client socket ... ) to a Marlin
+ *  server and return its exit code.
+ */
+int runClient( int argc, char** argv ){
 
-    std::cerr << " ***********************************************\n" 
-	      << " A runtime error occured - (uncaught exception):\n" 
-	      << "      " <<    e.what() << "\n"
-	      << " Marlin will have to be terminated, sorry.\n"  
-	      << " ***********************************************\n" 
-	      << std:: endl ; 
+    if( argc < 4 ){
+        std::cout << "  usage: Marlin --client socket [options] steer.xml" << std::endl << std::endl ;
+        return(1) ;
+    }
 
-    return 1 ;
+    std::vector<std::string> args( 1, argv[0] ) ;
+    args.insert( args.end(), argv + 3, argv + argc ) ;
 
-  }
+    char cwd[4096] ;
+    if( getcwd( cwd, sizeof( cwd ) ) == 0 ){
+        std::cerr << "  can't determine the current working directory" << std::endl ;
+        return(1) ;
+    }
 
+    return JobServer::submit( argv[2], args, cwd ) ;
 }
 
 //   void  createProcessors(XMLParser&  parser) {
@@ -602,6 +818,68 @@ void  createProcessors(Parser&  parser) {
     }
 }
 
+namespace {
+
+    /** Geometries preloaded by the job server - inherited by the forked jobs */
+    std::map< std::string, std::unique_ptr<gear::GearMgr> > gearCache ;
+
+    /** Key of a GEAR file in the cache: its name, modification time and size */
+    std::string gearFileKey( const std::string& gearFile ) {
+
+        struct stat st ;
+        if( stat( gearFile.c_str(), &st ) != 0 )
+            return "" ;
+
+        std::stringstream key ;
+        key << gearFile << " " << (long long) st.st_mtime << " " << (long long) st.st_size ;
+        return key.str() ;
+    }
+}
+
+/** Create the geometry for the given GEAR XML file in the cache of the job server.
+ */
+gear::GearMgr* preloadGearMgr( const std::string& gearFile ) {
+
+    std::unique_ptr<gear::GearMgr>& gearMgr = gearCache[ gearFileKey( gearFile ) ] ;
+
+    if( ! gearMgr ){
+
+        gear::GearXML gearXML( gearFile ) ;
+
+        gearMgr.reset( gearXML.createGearMgr() ) ;
+    }
+
+    return gearMgr.get() ;
+}
+
+/** Return the geometry preloaded by the job server for the given GEAR XML file - NULL if
+ *  there is none or the file changed since. Ordinary jobs have an empty cache and do not
+ *  look at the file.
+ */
+gear::GearMgr* preloadedGearMgr( const std::string& gearFile ) {
+
+    if( gearCache.empty() )
+        return 0 ;
+
+    std::map< std::string, std::unique_ptr<gear::GearMgr> >::const_iterator it = gearCache.find( gearFileKey( gearFile ) ) ;
+
+    return ( it != gearCache.end() ? it->second.get() : 0 ) ;
+}
+
+
+void printStartupProfile() {
+
+    StartupProfiler* prof = StartupProfiler::instance() ;
+    prof->finish() ;
+
+    if( Global::parameters->getStringVal("StartupProfile") == "true" )
+        prof->print() ;
+
+    std::string jsonFile = Global::parameters->getStringVal("StartupProfileFile") ;
+    if( ! jsonFile.empty() )
+        prof->writeJSON( jsonFile ) ;
+}
+
 void listAvailableProcessors() {
 
     ProcessorMgr::instance()->dumpRegisteredProcessors() ;
@@ -612,6 +890,13 @@ void listAvailableProcessorsXML() {
     ProcessorMgr::instance()->dumpRegisteredProcessorsXML() ;
 }
 
+void printXMLHeader() {
+
+    std::cout  << "<?xml version=\"1.0\" encoding=\"us-ascii\"?>" << std::endl
+        << "<!-- ?xml-stylesheet type=\"text/xsl\" href=\"http://ilcsoft.desy.de/marlin/marlin.xsl\"? -->" << std::endl
+        << "<!-- ?xml-stylesheet type=\"text/xsl\" href=\"marlin.xsl\"? -->" << std::endl << std::endl;
+}
+
 
 int printUsage() {
 
@@ -637,6 +922,15 @@ int printUsage() {
 	    << "     Marlin --global.LCIOInputFiles=\"input1.slcio input2.slcio\" --global.GearXMLFile=mydetector.xml" << std::endl 
 	    << "            --MyLCIOOutputProcessor.LCIOWriteMode=WRITE_APPEND --MyLCIOOutputProcessor.LCIOOutputFile=out.slcio steer.xml" << std::endl << std::endl
 	    << "     NOTE: Dynamic options do NOT work together with Marlin options (-x, -f) nor with the MarlinGUI" << std::endl
+	    << std::endl 
+	    << " Set MARLIN_REGISTRY_CACHE=/path/to/cachefile in your environment to only load the MARLIN_DLL" << std::endl
+	    << " libraries needed by the active processors (the cache is written in the first job)." << std::endl
+	    << " Set MARLIN_STEERING_CACHE=/path/to/directory to cache the parsed XML steering files." << std::endl
+	    << std::endl 
+	    << " Running many short jobs with a job server, that loads the MARLIN_DLL libraries and GEAR files once:" << std::endl
+	    << "   Marlin --server /tmp/marlin.sock [gear.xml ...] \t start the server" << std::endl
+	    << "   Marlin --client /tmp/marlin.sock [OPTION] [FILE]\t run the job in a fork of the server" << std::endl
+	    << "     the job runs in the current directory with the environment of the server" << std::endl
 	    << std::endl ;
   
   return(0) ;
@@ -1134,7 +1134,8 @@ namespace marlin{
 	
       cout << setw(40) << left << _aProc[i]->getName() <<
 	setw(30) << left << _aProc[i]->getType() << 
-	" [ " <<  _aProc[i]->getStatusDesc() << " ] ";
+	" [ " <<  _aProc[i]->getStatusDesc() << " ] " <<
+	" [ " <<  _aProc[i]->getConcurrencyDesc() << " ] ";
 
       //print processor errors
       if( _aProc[i]->hasErrors() ){
@@ -0,0 +1,240 @@
+#include "marlin/MultiProcessRunner.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/Exceptions.h"
+
+#include "streamlog/streamlog.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace marlin{
+
+  namespace {
+
+    struct WorkerStopProcessing : public StopProcessingException {
+      WorkerStopProcessing( const std::string& m ) {
+	StopProcessingException::message = m ;
+      }
+    } ;
+  }
+
+
+  MultiProcessRunner::MultiProcessRunner( int nProcesses, int chunkSize, ProcessorMgr* procMgr ) :
+    _nProcesses( nProcesses ), _chunkSize( chunkSize > 0 ? chunkSize : 1 ), _procMgr( procMgr ),
+    _maxChunks( 1L << 24 ) {
+
+    // only the pages of the chunks read are actually allocated - the last flag is the stop request
+    void* mem = mmap( 0, ( _maxChunks + 1 ) * sizeof( std::atomic<unsigned char> ), PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 ) ;
+
+    if( mem == MAP_FAILED )
+      throw lcio::Exception( std::string( "MultiProcessRunner: can't create shared memory: " ) + std::strerror( errno ) ) ;
+
+    _claimed = static_cast< std::atomic<unsigned char>* >( mem ) ;
+    _stop = _claimed + _maxChunks ;
+  }
+
+
+  MultiProcessRunner::~MultiProcessRunner() {
+
+    // the statistics directory is left if wait() was not called
+    if( _workerID < 0 && ! _statsDir.empty() ) {
+
+      for( unsigned i=0 ; i < _workers.size() ; ++i )
+	std::remove( statisticsFile( i ).c_str() ) ;
+
+      rmdir( _statsDir.c_str() ) ;
+    }
+
+    munmap( _claimed, ( _maxChunks + 1 ) * sizeof( std::atomic<unsigned char> ) ) ;
+  }
+
+
+  int MultiProcessRunner::start() {
+
+    streamlog_out( MESSAGE ) << " ---- starting " << _nProcesses << " worker processes - processing chunks of "
+			     << _chunkSize << " events " << std::endl ;
+
+    // the workers write their statistics to a directory only accessible to this user
+    const char* tmp = getenv( "TMPDIR" ) ;
+
+    std::string dirName = std::string( tmp != 0 && std::strlen( tmp ) > 0 ? tmp : "/tmp" ) + "/marlin_XXXXXX" ;
+
+    if( mkdtemp( &dirName[0] ) == 0 )
+      throw lcio::Exception( "MultiProcessRunner: can't create directory " + dirName + ": " + std::strerror( errno ) ) ;
+
+    _statsDir = dirName ;
+
+    std::cout.flush() ;
+    std::cerr.flush() ;
+    std::fflush( 0 ) ;
+
+    for( int i=0 ; i < _nProcesses ; ++i ) {
+
+      pid_t pid = fork() ;
+
+      if( pid == 0 ) {
+
+	_workerID = i ;
+	_workers.clear() ;
+
+	_procMgr->workerStarted( i ) ;
+
+	return _workerID ;
+      }
+
+      if( pid < 0 ) {
+
+	// the workers started so far will process all events
+	streamlog_out( ERROR ) << " MultiProcessRunner: can't fork worker " << i << ": " << std::strerror( errno ) << std::endl ;
+	break ;
+      }
+
+      _workers.push_back( pid ) ;
+    }
+
+    return -1 ;
+  }
+
+
+  std::string MultiProcessRunner::statisticsFile( int workerID ) const {
+
+    std::stringstream name ;
+    name << _statsDir << "/worker" << workerID << ".stats" ;
+    return name.str() ;
+  }
+
+
+  void MultiProcessRunner::finishWorker() {
+
+    std::ofstream out( statisticsFile( _workerID ).c_str() ) ;
+
+    _procMgr->writeStatistics( out ) ;
+
+    if( ! out )
+      streamlog_out( ERROR ) << " MultiProcessRunner: can't write statistics file " << statisticsFile( _workerID ) << std::endl ;
+  }
+
+
+  bool MultiProcessRunner::wait() {
+
+    bool ok = ! _workers.empty() ;
+
+    for( unsigned i=0 ; i < _workers.size() ; ++i ) {
+
+      int status = 0 ;
+      while( waitpid( _workers[i], &status, 0 ) < 0 && errno == EINTR ) ;
+
+      if( ! WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) {
+
+	streamlog_out( ERROR ) << " MultiProcessRunner: worker " << i << " failed - "
+			       << ( WIFEXITED( status ) ? "exit code " : "signal " )
+			       << ( WIFEXITED( status ) ? WEXITSTATUS( status ) : WTERMSIG( status ) ) << std::endl ;
+	ok = false ;
+      }
+
+      std::ifstream in( statisticsFile( i ).c_str() ) ;
+
+      if( in ) {
+	_procMgr->addStatistics( in ) ;
+	in.close() ;
+	std::remove( statisticsFile( i ).c_str() ) ;
+      }
+    }
+
+    if( ! _statsDir.empty() ) {
+      rmdir( _statsDir.c_str() ) ;
+      _statsDir.clear() ;
+    }
+
+    return ok ;
+  }
+
+
+  bool MultiProcessRunner::acceptEvent() {
+
+    const long chunk = _index / _chunkSize ;
+
+    if( chunk != _currentChunk ) {
+
+      _currentChunk = chunk ;
+
+      // the first worker that reaches the chunk processes it
+      _chunkAccepted = ( chunk < _maxChunks ?
+			 _claimed[ chunk ].exchange( 1 ) == 0 :
+			 chunk % _nProcesses == _workerID ) ;
+    }
+    return _chunkAccepted ;
+  }
+
+
+  void MultiProcessRunner::checkStop() {
+
+    if( _stop->load() != 0 )
+      throw WorkerStopProcessing( "stop requested in another worker process" ) ;
+  }
+
+
+  void MultiProcessRunner::processRunHeader( LCRunHeader* run ) {
+
+    checkStop() ;
+
+    _procMgr->setInputEventIndex( _index ) ;
+    _procMgr->processRunHeader( run ) ;
+  }
+
+  void MultiProcessRunner::modifyRunHeader( LCRunHeader* run ) {
+
+    checkStop() ;
+
+    _procMgr->setInputEventIndex( _index ) ;
+    _procMgr->modifyRunHeader( run ) ;
+  }
+
+  void MultiProcessRunner::modifyEvent( LCEvent* evt ) {
+
+    checkStop() ;
+
+    if( acceptEvent() ) {
+      _procMgr->setInputEventIndex( _index ) ;
+
+      try{
+	_procMgr->modifyEvent( evt ) ;
+      }
+      catch( StopProcessingException& ) {
+	_stop->store( 1 ) ;
+	throw ;
+      }
+    }
+  }
+
+  void MultiProcessRunner::processEvent( LCEvent* evt ) {
+
+    checkStop() ;
+
+    if( acceptEvent() ) {
+      _procMgr->setInputEventIndex( _index ) ;
+
+      try{
+	_procMgr->processEvent( evt ) ;
+      }
+      catch( StopProcessingException& ) {
+	// the other workers stop before their next record
+	_stop->store( 1 ) ;
+	throw ;
+      }
+    }
+
+    ++_index ;
+  }
+
+}
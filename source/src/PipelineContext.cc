@@ -0,0 +1,92 @@
+#include "marlin/PipelineContext.h"
+#include "marlin/Global.h"
+#include "marlin/EventDataService.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/ProcessorEventSeeder.h"
+#include "marlin/ResourceService.h"
+#include "marlin/StringParameters.h"
+
+namespace marlin{
+
+  namespace {
+    thread_local PipelineContext* currentContext = nullptr ;
+  }
+
+
+  PipelineContext* PipelineContext::defaultContext() {
+
+    static PipelineContext ctx( true ) ;
+    return &ctx ;
+  }
+
+
+  PipelineContext* PipelineContext::current() {
+
+    return ( currentContext != nullptr ? currentContext : defaultContext() ) ;
+  }
+
+
+  PipelineContext::PipelineContext() :
+    _isDefault( false ),
+    _parameters( _ownParameters ), _gear( _ownGear ),
+    _seeder( _ownSeeder ), _resources( _ownResources ), _eventData( _ownEventData ) {
+  }
+
+
+  PipelineContext::PipelineContext( bool ) :
+    _isDefault( true ),
+    _parameters( Global::parameters ), _gear( Global::GEAR ),
+    _seeder( Global::EVENTSEEDER ), _resources( Global::RESOURCES ), _eventData( Global::EVENTDATA ) {
+  }
+
+
+  PipelineContext::~PipelineContext() {
+
+    if( _isDefault )
+      return ;
+
+    delete _mgr ;
+    delete _seeder ;
+    delete _resources ;
+    delete _eventData ;
+    delete _gear ;
+  }
+
+
+  void PipelineContext::setParameters( std::shared_ptr<StringParameters> parameters ) {
+
+    _parameterHolder = parameters ;
+    _parameters = parameters.get() ;
+  }
+
+
+  void PipelineContext::setGear( gear::GearMgr* gearMgr ) {
+
+    if( ! _isDefault && _gear != gearMgr )
+      delete _gear ;
+
+    _gear = gearMgr ;
+  }
+
+
+  ProcessorMgr* PipelineContext::processorMgr() {
+
+    if( _isDefault )
+      return ProcessorMgr::defaultInstance() ;
+
+    if( _mgr == nullptr )
+      _mgr = new ProcessorMgr( this ) ;
+
+    return _mgr ;
+  }
+
+
+  PipelineContext::Scope::Scope( PipelineContext* ctx ) : _previous( currentContext ) {
+    currentContext = ctx ;
+  }
+
+  PipelineContext::Scope::~Scope() {
+    currentContext = _previous ;
+  }
+
+}
@@ -0,0 +1,66 @@
+#include "marlin/PolarAngleBinning.h"
+
+#include <algorithm>
+
+namespace marlin{
+
+  void PolarAngleBinning::init( const std::vector< std::pair<double,double> >& ranges ) {
+
+    _edges.clear() ;
+    _index.clear() ;
+    _first.clear() ;
+    _lower = 0. ;
+    _upper = -1. ;
+    _invWidth = 0. ;
+
+    for( unsigned i=0 ; i < ranges.size() ; ++i ) {
+      if( ranges[i].first < ranges[i].second ) {
+	_edges.push_back( ranges[i].first ) ;
+	_edges.push_back( ranges[i].second ) ;
+      }
+    }
+
+    if( _edges.empty() )
+      return ;
+
+    std::sort( _edges.begin(), _edges.end() ) ;
+    _edges.erase( std::unique( _edges.begin(), _edges.end() ), _edges.end() ) ;
+
+    // the first range containing a segment - membership only changes at the edges,
+    // so the upper edge of the segment decides
+    const unsigned nSeg = _edges.size() - 1 ;
+    _index.assign( nSeg, -1 ) ;
+
+    for( unsigned s=0 ; s < nSeg ; ++s ) {
+
+      const double theta = _edges[ s + 1 ] ;
+
+      for( unsigned i=0 ; i < ranges.size() ; ++i ) {
+	if( theta <= ranges[i].second && theta > ranges[i].first ) {
+	  _index[s] = i ;
+	  break ;
+	}
+      }
+    }
+
+    // a few bins per segment keep the number of steps in index() small
+    _lower = _edges.front() ;
+    _upper = _edges.back() ;
+
+    const unsigned nBins = std::min( 4 * nSeg, 1u << 16 ) ;
+    _invWidth = nBins / ( _upper - _lower ) ;
+    _first.resize( nBins ) ;
+
+    unsigned seg = 0 ;
+
+    for( unsigned b=0 ; b < nBins ; ++b ) {
+
+      const double low = _lower + b / _invWidth ;
+
+      while( seg + 1 < nSeg && _edges[ seg + 1 ] < low ) ++seg ;
+
+      _first[b] = seg ;
+    }
+  }
+
+}
@@ -1,6 +1,7 @@
 #include "marlin/Processor.h"
 #include "marlin/ProcessorMgr.h" 
 #include "marlin/Global.h"
+#include "marlin/PipelineContext.h"
 #include "marlin/VerbosityLevels.h"
 
 using namespace lcio ;
@@ -20,7 +21,7 @@ namespace marlin{
     _str(0) {
   
     //register processor in map
-    ProcessorMgr::instance()->registerProcessor( this ) ;
+    ProcessorMgr::defaultInstance()->registerProcessor( this ) ;
 
 
     registerOptionalParameter( "Verbosity" , 
@@ -33,6 +34,43 @@ namespace marlin{
 
   Processor::Processor() : _parameters(NULL), _isFirstEvent(false), _str(NULL) {}
 
+
+  PipelineContext* Processor::context() const {
+    return ( _context != nullptr ? _context : PipelineContext::defaultContext() ) ;
+  }
+
+
+  const char* Processor::concurrencyName( Concurrency c ) {
+
+    switch( c ) {
+    case CLONE_PER_THREAD : return "ClonePerThread" ;
+    case REENTRANT_SHARED : return "ReentrantShared" ;
+    default :               return "SerialOnly" ;
+    }
+  }
+
+
+  Processor* Processor::clone() {
+
+    Processor* p = newProcessor() ;
+
+    p->setName( _processorName ) ;
+    p->_context = _context ;
+    p->_parameters = _parameters ;
+
+    // copy the already parsed values instead of parsing the StringParameters again
+    for( ProcParamMap::iterator i = _map.begin() ; i != _map.end() ; i ++ ) {
+
+      ProcParamMap::iterator it = p->_map.find( i->first ) ;
+
+      if( it != p->_map.end() ) 
+	it->second->copyValue( i->second ) ;
+    }
+    p->_logLevelName = _logLevelName ;
+
+    return p ;
+  }
+
   Processor::~Processor() {
 
     if( _str !=0 )
@@ -88,6 +126,7 @@ namespace marlin{
 	      << "ProcessorType "   <<  type() << std::endl ;
     
     std::cout << "#---" << description() << std::endl ;
+    std::cout << "#--- concurrency: " << concurrencyName( concurrency() ) << std::endl ;
     
     typedef ProcParamMap::iterator PMI ;
     
@@ -147,6 +186,7 @@ namespace marlin{
     }
     
     stream << " <!--" << description() << "-->" << std::endl ;
+    stream << " <!--Concurrency: " << concurrencyName( concurrency() ) << "-->" << std::endl ;
     
     typedef ProcParamMap::iterator PMI ;
     
@@ -231,7 +271,7 @@ namespace marlin{
 
   void Processor::setReturnValue( bool val) {
     
-    ProcessorMgr::instance()->setProcessorReturnValue(  this , val ) ;
+    context()->processorMgr()->setProcessorReturnValue(  this , val ) ;
   }
   
   void Processor::setLCIOInType(const std::string& collectionName,  const std::string& lcioInType) {
@@ -270,7 +310,7 @@ namespace marlin{
 
   void Processor::setReturnValue( const std::string& keyName, bool val ){
   
-    ProcessorMgr::instance()->setProcessorReturnValue(  this , val , keyName ) ;
+    context()->processorMgr()->setProcessorReturnValue(  this , val , keyName ) ;
   }
 
 
@@ -1,6 +1,7 @@
 #include "marlin/ProcessorEventSeeder.h"
 #include "marlin/Processor.h"
-#include "marlin/Global.h"
+#include "marlin/PipelineContext.h"
+#include "marlin/StringParameters.h"
 
 #include "jenkinsHash.h"
 
@@ -11,20 +12,46 @@
 namespace marlin{
 
 
-  ProcessorEventSeeder::ProcessorEventSeeder() : _global_seed(0), _global_seed_set(false), _eventProcessingStarted(false), _vector_pair_proc_seed()
+  ProcessorEventSeeder::ProcessorEventSeeder( PipelineContext* ctx ) : _global_seed(0), _global_seed_set(false), _eventProcessingStarted(false),
+						 _mode( PHILOX ), _context( ctx ), _eventNumber(0), _runNumber(0),
+						 _vector_pair_proc_seed(), _procIds(), _procIndex()
   {
   } 
 
+
+  void ProcessorEventSeeder::readGlobalParameters() {
+
+    if( _global_seed_set ) 
+      return ;
+
+    _global_seed = _context->parameters()->getIntVal("RandomSeed" ) ;
+    _global_seed_set = true;
+
+    const std::string& mode = _context->parameters()->getStringVal("RandomSeedMode" ) ;
+
+    if( mode.empty() || mode == "Philox" ) {
+      _mode = PHILOX ;
+    }
+    else if( mode == "JenkinsHash" ) {
+      _mode = JENKINS_HASH ;
+    }
+    else {
+      throw Exception( std::string("ProcessorEventSeeder: unknown RandomSeedMode \"") + mode 
+		       + "\" - use either Philox or JenkinsHash" ) ;
+    }
+
+    streamlog_out(DEBUG) << "ProcessorEventSeeder: using global seed " << _global_seed
+			 << " and seeding mode " << ( _mode == PHILOX ? "Philox" : "JenkinsHash" ) << std::endl ;
+  }
+
   
   void ProcessorEventSeeder::registerProcessor( Processor* proc ) {
 
-    
-    if( _global_seed_set == false ) {
-      _global_seed = Global::parameters->getIntVal("RandomSeed" ) ;
-      _global_seed_set = true;
-    }
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    readGlobalParameters() ;
 
-    if ( _eventProcessingStarted ) { // event processing started, so disallow any more calls to registerProcessor
+    if ( _eventProcessingStarted && ! _lateInit ) { // event processing started, so disallow any more calls to registerProcessor
       streamlog_out(ERROR) << "ProcessorEventSeeder:registerProcessor( Processor* proc ) called from Processor: " 
 			   << proc->name() << std::endl << "The method registerProcessor( Processor* proc ) must be called in the init() method of the Processor" 
 			   << std::endl;
@@ -32,25 +59,85 @@ namespace marlin{
       throw Exception("ProcessorEventSeeder: Event Processing has already started. registerProcessor( Processor* proc ) must be called in the init() method");
     }
 
-    // just in case any body has called rand since we set the seed 
-    srand( _global_seed );
-    streamlog_out(DEBUG) << "ProcessorEventSeeder: srand initialised with global seed " << _global_seed << std::endl; 
+    // the processor id used as key for the counter based generator only depends on its name
+    const std::string& name = proc->name() ;
+    unsigned int procId = jenkins_hash( (unsigned char*) name.c_str() , name.size() , 0 ) ;
+
+    _procIndex[ proc ] = _vector_pair_proc_seed.size() ;
+    _procIds.push_back( procId ) ;
+
+    unsigned int initialSeed = 0 ;
 
-    _vector_pair_proc_seed.push_back( std::make_pair( proc, rand() ) );
+    if( _mode == JENKINS_HASH ) {
+      // just in case any body has called rand since we set the seed 
+      srand( _global_seed );
+      streamlog_out(DEBUG) << "ProcessorEventSeeder: srand initialised with global seed " << _global_seed << std::endl; 
+      initialSeed = rand() ;
+    }
+
+    _vector_pair_proc_seed.push_back( std::make_pair( proc, initialSeed ) );
     streamlog_out(DEBUG) << "ProcessorEventSeeder: Processor " << proc->name()
                          << " registered for random seed service. Allocated "
-                         <<  _vector_pair_proc_seed.back().second << " as initial seed." << std::endl;
+                         <<  procId << " as processor id." << std::endl;
 
+    // processor initialized for its first event (LazyInit) - it needs a seed for the current event
+    if( _eventProcessingStarted && _mode == JENKINS_HASH )
+      computeSeeds() ;
   }
 
+  void ProcessorEventSeeder::sortRegistered( const std::vector<Processor*>& order ) {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    std::unordered_map< const Processor*, unsigned > position ;
+    for( unsigned i=0 ; i < order.size() ; ++i ) 
+      position[ order[i] ] = i ;
+
+    // processors not in the given order keep their relative order at the end
+    std::vector<unsigned> idx( _vector_pair_proc_seed.size() ) ;
+    for( unsigned i=0 ; i < idx.size() ; ++i ) 
+      idx[i] = i ;
+
+    auto pos = [&]( unsigned i ) {
+      auto it = position.find( _vector_pair_proc_seed[i].first ) ;
+      return it != position.end() ? it->second : order.size() ;
+    } ;
+    std::stable_sort( idx.begin(), idx.end(), [&]( unsigned a, unsigned b ){ return pos( a ) < pos( b ) ; } ) ;
+
+    std::vector< std::pair<Processor*, unsigned int> > procSeeds ;
+    std::vector< unsigned int > procIds ;
+
+    for( unsigned i=0 ; i < idx.size() ; ++i ) {
+      procSeeds.push_back( _vector_pair_proc_seed[ idx[i] ] ) ;
+      procIds.push_back( _procIds[ idx[i] ] ) ;
+      _procIndex[ procSeeds.back().first ] = i ;
+    }
+    _vector_pair_proc_seed.swap( procSeeds ) ;
+    _procIds.swap( procIds ) ;
+  }
+
+
   void ProcessorEventSeeder::refreshSeeds( LCEvent * evt ) {
 
     _eventProcessingStarted = true; // event processing started so disallow any more calls to registerProcessor
 
+    _eventNumber = evt->getEventNumber() ;
+    _runNumber = evt->getRunNumber() ;
+
+    // seeds are computed on request in getSeed()
+    if( _mode == PHILOX ) 
+      return ;
+
+    computeSeeds() ;
+  }
+
+
+  void ProcessorEventSeeder::computeSeeds() {
+
     // get hashed seed using jenkins_hash
     unsigned int seed = 0 ; // initial state
-    unsigned int eventNumber = evt->getEventNumber() ;
-    unsigned int runNumber = evt->getRunNumber() ;
+    unsigned int eventNumber = _eventNumber ;
+    unsigned int runNumber = _runNumber ;
 
     unsigned char * c = (unsigned char *) &eventNumber ;
     seed = jenkins_hash( c, sizeof eventNumber, seed) ;
@@ -73,15 +160,64 @@ namespace marlin{
     }
     
   }
+
+
+  unsigned ProcessorEventSeeder::getIndex( const Processor* proc ) const {
+
+    auto it = _procIndex.find( proc ) ;
+
+    if( it == _procIndex.end() ) {
+      throw Exception( std::string("ProcessorEventSeeder: Processor ") + proc->name() 
+		       + " not registered - call registerProcessor( this ) in the init() method" ) ;
+    }
+    return it->second ;
+  }
+
+
+  RandomStream ProcessorEventSeeder::stream( unsigned index, unsigned int eventNumber, unsigned int runNumber ) const {
+    
+    return RandomStream( {{ (unsigned int) _global_seed , _procIds[ index ] }} , {{ eventNumber, runNumber, 0, 0 }} ) ;
+  }
+
   
   unsigned int ProcessorEventSeeder::getSeed( Processor* proc ) {
     
-    typedef std::pair<Processor*, unsigned int> Pair;
-    
-    auto it = find_if( _vector_pair_proc_seed.begin(), _vector_pair_proc_seed.end(), [&](Pair const& pair){ return pair.first == proc; } );
+    unsigned index = getIndex( proc ) ;
+
+    if( _mode == JENKINS_HASH ) 
+      return _vector_pair_proc_seed[ index ].second ;
+
+    // keep the range of rand(), i.e. the seed can safely be converted to a (positive) int
+    return stream( index, _eventNumber, _runNumber )() & 0x7fffffff ;
+  }
+
+
+  unsigned int ProcessorEventSeeder::getSeed( Processor* proc, const LCEvent* evt ) const {
+
+    if( _mode == JENKINS_HASH ) 
+      throw Exception( "ProcessorEventSeeder::getSeed( proc , evt ) not available for RandomSeedMode JenkinsHash" ) ;
+
+    return stream( getIndex( proc ), evt->getEventNumber(), evt->getRunNumber() )() & 0x7fffffff ;
+  }
+
+
+  RandomStream ProcessorEventSeeder::getRandomStream( Processor* proc ) {
+
+    unsigned index = getIndex( proc ) ;
+
+    if( _mode == JENKINS_HASH ) 
+      return RandomStream( {{ _vector_pair_proc_seed[ index ].second , _procIds[ index ] }} , {{ 0, 0, 0, 0 }} ) ;
+
+    return stream( index, _eventNumber, _runNumber ) ;
+  }
+
+
+  RandomStream ProcessorEventSeeder::getRandomStream( Processor* proc, const LCEvent* evt ) const {
 
-    return ( it != _vector_pair_proc_seed.end() ? it->second : throw ) ;
+    if( _mode == JENKINS_HASH ) 
+      throw Exception( "ProcessorEventSeeder::getRandomStream( proc , evt ) not available for RandomSeedMode JenkinsHash" ) ;
 
+    return stream( getIndex( proc ), evt->getEventNumber(), evt->getRunNumber() ) ;
   }
 
 } // namespace marlin
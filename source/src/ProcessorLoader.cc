@@ -1,7 +1,14 @@
 #include "marlin/ProcessorLoader.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/StartupProfiler.h"
 
 #include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
 #include <cstdlib>
 #include <set>
 
@@ -11,64 +18,252 @@ namespace marlin{
 
 ProcessorLoader::ProcessorLoader(
         lcio::StringVec::const_iterator first, 
-        lcio::StringVec::const_iterator last ) {
+        lcio::StringVec::const_iterator last ) : _libNames( first, last ) {
 
+    loadAll() ;
+}
+
+
+ProcessorLoader::ProcessorLoader(
+        lcio::StringVec::const_iterator first, 
+        lcio::StringVec::const_iterator last,
+        const std::string& registryCacheFile ) : _libNames( first, last ), _cacheFile( registryCacheFile ) {
+
+    if( readCache() ){
+        std::cout << "<!-- Using processor registry cache " << _cacheFile 
+                  << " - shared libraries are loaded on demand -->" << std::endl ;
+    }
+    else{
+        _typeToLib.clear() ;
+        loadAll() ;
+
+        if( ! _loadError )
+            writeCache() ;
+    }
+}
 
-    _loadError=false;
-    lcio::StringVec::const_iterator current = first ;
 
-    std::set<std::string> _checkDuplicateLibs;
+void ProcessorLoader::loadAll() {
 
-    while( current != last ){
+    for( unsigned i=0 ; i < _libNames.size() && ! _loadError ; ++i ){
 
-        std::string libName( *current ) ;
-        size_t idx;
-        idx = libName.find_last_of("/");
-        // the library basename, i.e. /path/to/libBlah.so --> libBlah.so
-        std::string libBaseName( libName.substr( idx + 1 ) );
+        if( _loaded.find( i ) == _loaded.end() )
+            loadLibrary( i ) ;
+    }
+}
+
+
+void ProcessorLoader::loadForTypes( const std::set<std::string>& types ) {
+
+    std::set<unsigned> needed ;
+    std::set< std::string > registered = ProcessorMgr::instance()->getAvailableProcessorTypes() ;
 
-        char *real_path = realpath(libName.c_str(), NULL);
+    // libraries without processors are given for their symbols (dependencies, dictionaries,
+    // plugins) - they are always loaded
+    std::set<unsigned> withProcessors ;
+    for( std::map< std::string, unsigned >::const_iterator it = _typeToLib.begin() ; it != _typeToLib.end() ; ++it )
+        withProcessors.insert( it->second ) ;
 
-        if( real_path != NULL ){
-            std::cout << "<!-- Loading shared library : " << real_path << " ("<< libBaseName << ")-->" << std::endl ;
+    for( unsigned i=0 ; i < _libNames.size() ; ++i ){
+        if( withProcessors.find( i ) == withProcessors.end() )
+            needed.insert( i ) ;
+    }
+
+    for( std::set<std::string>::const_iterator it = types.begin() ; it != types.end() ; ++it ){
+
+        std::map< std::string, unsigned >::const_iterator itT = _typeToLib.find( *it ) ;
 
-            // use real_path
-            free(real_path);
+        if( itT != _typeToLib.end() ){
+            needed.insert( itT->second ) ;
         }
-        else{
-            std::cout << "<!-- Loading shared library : " << libName << " ("<< libBaseName << ")-->" << std::endl ;
+        else if( registered.find( *it ) == registered.end() ){
+
+            std::cout << "<!-- processor type " << *it << " not found in registry cache " << _cacheFile
+                      << " - loading all shared libraries -->" << std::endl ;
+            loadAll() ;
+            return ;
         }
+    }
+
+    // load in the order given in MARLIN_DLL
+    for( std::set<unsigned>::const_iterator it = needed.begin() ; it != needed.end() ; ++it ){
+
+        // all symbols are resolved at load time, so that missing symbols are found here and
+        // not when a processor is called
+        if( _loaded.find( *it ) == _loaded.end() )
+            loadLibrary( *it, RTLD_NOW | RTLD_GLOBAL ) ;
 
-        
-        if( _checkDuplicateLibs.find( libBaseName ) == _checkDuplicateLibs.end() ){
-            _checkDuplicateLibs.insert( libBaseName ) ;
+        if( _loadError ){
+            // e.g. the library needs symbols from other MARLIN_DLL libraries - retry in the given order
+            std::cout << "<!-- loading on demand failed - loading all shared libraries -->" << std::endl ;
+            const std::string& libName = _libNames[ *it ] ;
+            _checkDuplicateLibs.erase( libName.substr( libName.find_last_of("/") + 1 ) ) ;
+            _loaded.erase( *it ) ;
+            _loadError = false ;
+            loadAll() ;
+            return ;
         }
-        else{
+    }
+}
+
+
+void ProcessorLoader::loadLibrary( unsigned i, int mode ) {
+
+    std::string libName( _libNames[i] ) ;
+    size_t idx;
+    idx = libName.find_last_of("/");
+    // the library basename, i.e. /path/to/libBlah.so --> libBlah.so
+    std::string libBaseName( libName.substr( idx + 1 ) );
+
+    char *real_path = realpath(libName.c_str(), NULL);
+
+    if( real_path != NULL ){
+        std::cout << "<!-- Loading shared library : " << real_path << " ("<< libBaseName << ")-->" << std::endl ;
+
+        // use real_path
+        free(real_path);
+    }
+    else{
+        std::cout << "<!-- Loading shared library : " << libName << " ("<< libBaseName << ")-->" << std::endl ;
+    }
+
+    _loaded.insert( i ) ;
+    
+    if( _checkDuplicateLibs.find( libBaseName ) == _checkDuplicateLibs.end() ){
+        _checkDuplicateLibs.insert( libBaseName ) ;
+    }
+    else{
+        std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
+            << "    ->    Trying to load DUPLICATE library -->" << std::endl << std::endl ;
+        _loadError=true;
+    }
+
+
+    if( ! _loadError ){
+
+        std::set< std::string > before = ProcessorMgr::instance()->getAvailableProcessorTypes() ;
+
+        StartupProfiler::Phase phase( "library", libBaseName ) ;
+
+        //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW) ;
+        //void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY ) ;
+        //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW | RTLD_GLOBAL) ;
+        void* libPointer  = dlopen( libName.c_str() , mode ) ;
+
+        phase.stop() ;
+
+        if( libPointer == 0 ){
             std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
-                << "    ->    Trying to load DUPLICATE library -->" << std::endl << std::endl ;
+                      << "    ->    "   << dlerror() << " -->" << std::endl << std::endl ;
             _loadError=true;
         }
+        else{
+            _libs.push_back( libPointer ) ;
 
+            // processor types registered by the static prototypes of this library
+            std::set< std::string > after = ProcessorMgr::instance()->getAvailableProcessorTypes() ;
 
-        if( ! _loadError ){
+            for( std::set<std::string>::const_iterator it = after.begin() ; it != after.end() ; ++it ){
+                if( before.find( *it ) == before.end() )
+                    _typeToLib[ *it ] = i ;
+            }
+        }
+    }
+}
 
-            //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW) ;
-            //void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY ) ;
-            //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW | RTLD_GLOBAL) ;
-            void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY | RTLD_GLOBAL) ;
 
-            if( libPointer == 0 ){
-                std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
-                          << "    ->    "   << dlerror() << " -->" << std::endl << std::endl ;
-                _loadError=true;
-            }
-            else{
-                _libs.push_back( libPointer ) ;
+// the cache is valid if the same libraries are given in the same order and none has changed
+bool ProcessorLoader::readCache() {
+
+    std::ifstream in( _cacheFile.c_str() ) ;
+
+    if( ! in )
+        return false ;
+
+    std::string line ;
+    unsigned nLib = 0 ;
+    int current = -1 ;
+
+    while( std::getline( in, line ) ){
+
+        std::istringstream is( line ) ;
+        std::string key ;
+        is >> key ;
+
+        if( key == "library" ){
+
+            long long mtime = 0, size = 0 ;
+            std::string name ;
+            is >> mtime >> size >> name ;
+
+            struct stat st ;
+            if( nLib >= _libNames.size() || name != _libNames[ nLib ] ||
+                stat( name.c_str(), &st ) != 0 ||
+                (long long) st.st_mtime != mtime || (long long) st.st_size != size ){
+                return false ;
             }
+            current = nLib++ ;
         }
+        else if( key == "processor" && current >= 0 ){
 
-        ++current ;
+            std::string type ;
+            is >> type ;
+            _typeToLib[ type ] = current ;
+        }
+    }
+
+    return nLib == _libNames.size() ;
+}
+
+
+void ProcessorLoader::writeCache() const {
+
+    // a temporary file of this job in the directory of the cache - concurrent jobs write
+    // their own files and rename them
+    std::string tmpFile = _cacheFile + ".XXXXXX" ;
+    const int fd = mkstemp( &tmpFile[0] ) ;
+
+    if( fd < 0 ){
+        std::cout << "<!-- WARNING: can't write processor registry cache " << _cacheFile << " -->" << std::endl ;
+        return ;
+    }
+
+    // mkstemp() creates the file readable only for the user - the cache is shared
+    fchmod( fd, 0644 ) ;
+    close( fd ) ;
+
+    std::ofstream out( tmpFile.c_str() ) ;
+
+    if( ! out ){
+        std::cout << "<!-- WARNING: can't write processor registry cache " << _cacheFile << " -->" << std::endl ;
+        std::remove( tmpFile.c_str() ) ;
+        return ;
+    }
+
+    out << "# Marlin processor registry cache - generated, do not edit" << std::endl ;
+
+    for( unsigned i=0 ; i < _libNames.size() ; ++i ){
+
+        struct stat st ;
+        if( stat( _libNames[i].c_str(), &st ) != 0 ){
+            out.close() ;
+            std::remove( tmpFile.c_str() ) ;
+            return ;
+        }
+
+        out << "library " << (long long) st.st_mtime << " " << (long long) st.st_size << " " << _libNames[i] << std::endl ;
+
+        for( std::map< std::string, unsigned >::const_iterator it = _typeToLib.begin() ; it != _typeToLib.end() ; ++it ){
+            if( it->second == i )
+                out << "processor " << it->first << std::endl ;
+        }
+    }
+    out.close() ;
 
+    // replace the cache atomically, e.g. for concurrent jobs
+    if( ! out || std::rename( tmpFile.c_str(), _cacheFile.c_str() ) != 0 ){
+        std::cout << "<!-- WARNING: can't write processor registry cache " << _cacheFile << " -->" << std::endl ;
+        std::remove( tmpFile.c_str() ) ;
     }
 }
 
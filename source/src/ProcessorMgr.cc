@@ -6,13 +6,23 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <mutex>
 #include <set>
+#include <thread>
 
 #include "marlin/DataSourceProcessor.h"
+#include "marlin/EventDataService.h"
 #include "marlin/EventModifier.h"
 #include "marlin/ProcessorEventSeeder.h"
+#include "marlin/ResourceService.h"
+#include "marlin/PipelineContext.h"
+#include "marlin/StartupProfiler.h"
 #include "streamlog/streamlog.h"
 #include "streamlog/logbuffer.h"
+#include "IMPL/LCRunHeaderImpl.h"
 
 #include <time.h>
 
@@ -20,9 +30,31 @@ namespace marlin{
 
     ProcessorMgr* ProcessorMgr::_me = 0 ;
 
-    static clock_t start_t , end_t ; 
-    typedef std::map< Processor* , std::pair< double  , int > > TimeMap ;
-    static TimeMap tMap ;
+    thread_local const Processor* ConcurrentLogGuard::threadProcessor = 0 ;
+
+    namespace {
+        // recursive: a processor may call streamlog_out while printing, e.g. in printParameters()
+        std::recursive_mutex concurrentLogMutex ;
+    }
+
+    void ConcurrentLogGuard::lock() {
+
+        concurrentLogMutex.lock() ;
+
+        _scope = new streamlog::logscope( streamlog::out ) ;
+        _scope->setName( threadProcessor->name() ) ;
+        _scope->setLevel( threadProcessor->logLevelName() ) ;
+    }
+
+    void ConcurrentLogGuard::unlock() {
+
+        delete _scope ;
+        _scope = 0 ;
+
+        concurrentLogMutex.unlock() ;
+    }
+
+    typedef ProcessorTimeMap TimeMap ;
 
 
 
@@ -45,20 +77,188 @@ namespace marlin{
     // create a dummy streamlog stream for std::cout 
     streamlog::logstream my_cout ;
 
-  ProcessorMgr::ProcessorMgr(){
-    if( Global::EVENTSEEDER == NULL ) {
-      Global::EVENTSEEDER = new ProcessorEventSeeder() ;
+
+    /** Copy of a run header, including its parameters.
+     */
+    LCRunHeader* copyRunHeader( const LCRunHeader* run ) {
+
+        LCRunHeaderImpl* copy = new LCRunHeaderImpl ;
+
+        copy->setRunNumber( run->getRunNumber() ) ;
+        copy->setDetectorName( run->getDetectorName() ) ;
+        copy->setDescription( run->getDescription() ) ;
+
+        const StringVec* dets = run->getActiveSubdetectors() ;
+        for( unsigned i=0 ; dets != 0 && i < dets->size() ; ++i ) {
+            copy->addActiveSubdetector( (*dets)[i] ) ;
+        }
+
+        const LCParameters& params = run->getParameters() ;
+        StringVec keys ;
+
+        params.getIntKeys( keys ) ;
+        for( unsigned i=0 ; i < keys.size() ; ++i ) {
+            IntVec values ;
+            copy->parameters().setValues( keys[i] , params.getIntVals( keys[i] , values ) ) ;
+        }
+        keys.clear() ;
+        params.getFloatKeys( keys ) ;
+        for( unsigned i=0 ; i < keys.size() ; ++i ) {
+            FloatVec values ;
+            copy->parameters().setValues( keys[i] , params.getFloatVals( keys[i] , values ) ) ;
+        }
+        keys.clear() ;
+        params.getStringKeys( keys ) ;
+        for( unsigned i=0 ; i < keys.size() ; ++i ) {
+            StringVec values ;
+            copy->parameters().setValues( keys[i] , params.getStringVals( keys[i] , values ) ) ;
+        }
+        return copy ;
+    }
+
+
+    /** Ends the event in the EventDataService when the scope is left, also if an exception
+     *  is thrown - unless released.
+     */
+    class EndEventGuard {
+    public:
+      EndEventGuard( EventDataService* service, const LCEvent* evt ) : _service( service ), _evt( evt ) {}
+      ~EndEventGuard() { if( _evt != nullptr ) _service->endEvent( _evt ) ; }
+      void release() { _evt = nullptr ; }
+    private:
+      EndEventGuard( const EndEventGuard& ) = delete ;
+      EndEventGuard& operator=( const EndEventGuard& ) = delete ;
+      EventDataService* _service ;
+      const LCEvent* _evt ;
+    } ;
+
+
+    // output of the current thread while processors are called concurrently
+    thread_local std::stringbuf* threadOutput = nullptr ;
+
+    /** Stream buffer for std::cout that writes to the buffer of the current thread if set.
+     */
+    class ThreadOutputBuffer : public std::streambuf {
+    public:
+      ThreadOutputBuffer( std::streambuf* sb ) : _sb( sb ) {}
+      std::streambuf* target() const { return _sb ; }
+    protected:
+      int overflow( int c ) {
+        if( c == traits_type::eof() )
+          return traits_type::not_eof( c ) ;
+        return ( threadOutput ? threadOutput : _sb )->sputc( traits_type::to_char_type( c ) ) ;
+      }
+      std::streamsize xsputn( const char* s, std::streamsize n ) {
+        return ( threadOutput ? threadOutput : _sb )->sputn( s, n ) ;
+      }
+      int sync() {
+        return threadOutput ? 0 : _sb->pubsync() ;
+      }
+    private:
+      std::streambuf* _sb ;
+    } ;
+
+
+    // names of the input or output collections of the processor given in the steering file
+    std::set<std::string> collectionNames( Processor* proc , bool input ) {
+
+        std::set<std::string> names ;
+
+        if( ! proc->parameters() )
+            return names ;
+
+        StringVec keys ;
+        proc->parameters()->getStringKeys( keys ) ;
+
+        for( unsigned i=0 ; i < keys.size() ; ++i ) {
+
+            if( input ? proc->isInputCollectionName( keys[i] ) : proc->isOutputCollectionName( keys[i] ) ) {
+
+                StringVec values ;
+                proc->parameters()->getStringVals( keys[i] , values ) ;
+                names.insert( values.begin() , values.end() ) ;
+            }
+        }
+        return names ;
+    }
+
+    bool intersect( const std::set<std::string>& s1 , const std::set<std::string>& s2 ) {
+
+        for( std::set<std::string>::const_iterator it = s1.begin() ; it != s1.end() ; ++it ) {
+            if( s2.find( *it ) != s2.end() )
+                return true ;
+        }
+        return false ;
+    }
+
+    /** The independent processors starting at first that can be called concurrently: all
+     *  declared Processor::independentInit() and no processor reads a collection written by
+     *  another one in the batch.
+     */
+    template <class Iterator>
+    std::vector<Processor*> independentBatch( Iterator first , Iterator last , bool enabled , 
+                                              const std::set<Processor*>& excluded ) {
+
+        std::vector<Processor*> batch( 1 , *first ) ;
+
+        if( ! enabled || ! (*first)->independentInit() )
+            return batch ;
+
+        std::set<std::string> inputs = collectionNames( *first , true ) ;
+        std::set<std::string> outputs = collectionNames( *first , false ) ;
+
+        for( Iterator it = ++first ; it != last && (*it)->independentInit() && ! excluded.count( *it ) ; ++it ) {
+
+            std::set<std::string> in = collectionNames( *it , true ) ;
+            std::set<std::string> out = collectionNames( *it , false ) ;
+
+            if( intersect( in , outputs ) || intersect( out , inputs ) || intersect( out , outputs ) )
+                break ;
+
+            inputs.insert( in.begin() , in.end() ) ;
+            outputs.insert( out.begin() , out.end() ) ;
+            batch.push_back( *it ) ;
+        }
+        return batch ;
+    }
+
+  ProcessorMgr::ProcessorMgr() : ProcessorMgr( PipelineContext::defaultContext() ) {
+  }
+
+  ProcessorMgr::ProcessorMgr( PipelineContext* ctx ) : _context( ctx ) {
+    if( _context->_seeder == NULL ) {
+      _context->_seeder = new ProcessorEventSeeder( _context ) ;
     }
     else {
       std::stringstream sstr ;
-      sstr << " ProcessorMgr::instance: Global::EVENTSEEDER pointer not NULL" << std::endl   ;
+      sstr << " ProcessorMgr::ProcessorMgr: the ProcessorEventSeeder of the pipeline context is not NULL" << std::endl   ;
       throw Exception( sstr.str() );
     }
+    if( _context->_resources == NULL ) {
+      _context->_resources = new ResourceService ;
+    }
+    if( _context->_eventData == NULL ) {
+      _context->_eventData = new EventDataService ;
+    }
   }
   
 
   ProcessorMgr* ProcessorMgr::instance() {
 
+    PipelineContext* ctx = PipelineContext::current() ;
+
+    if( ! ctx->isDefault() )
+      return ctx->processorMgr() ;
+
+    return defaultInstance() ;
+  }  
+
+  bool ProcessorMgr::inConcurrentCall() {
+    return threadOutput != nullptr ;
+  }
+
+  ProcessorMgr* ProcessorMgr::defaultInstance() {
+
     if( _me == 0 ) {
       _me = new ProcessorMgr ;
     }
@@ -72,6 +272,11 @@ namespace marlin{
 
     void ProcessorMgr::registerProcessor( Processor* processor ){
 
+        if( this != _me ) {  // processor types are registered process wide
+            defaultInstance()->registerProcessor( processor ) ;
+            return ;
+        }
+
         const std::string& name = processor->type()  ;
 
         if( _map.find( name ) != _map.end() ){
@@ -82,14 +287,19 @@ namespace marlin{
 
             return ;
         }
-        else
+        else{
 
             _map[ name ] = processor ;
 
+            StartupProfiler::instance()->processorRegistered() ;
+        }
+
     }
 
     void ProcessorMgr::readDataSource( int numEvents ) {
 
+        PipelineContext::Scope ctxScope( _context ) ;
+
         for(  ProcessorList::iterator it = _list.begin() ;
                 it != _list.end() ; it++ ){
 
@@ -177,10 +387,26 @@ namespace marlin{
 		   <<  "  <parameter name=\"SupressCheck\" value=\"false\" />  " << std::endl
 		   <<  "  <parameter name=\"AllowToModifyEvent\" value=\"false\" />  " << std::endl
 		   <<  "  <parameter name=\"GearXMLFile\"></parameter>  " << std::endl
+		   <<  "  <!-- print the full GEAR geometry after it has been created: -->  " << std::endl
+		   <<  "  <!--parameter name=\"PrintGearGeometry\" value=\"true\" /-->" << std::endl
 		   <<  "  <parameter name=\"Verbosity\" options=\"DEBUG0-4,MESSAGE0-4,WARNING0-4,ERROR0-4,SILENT\"> DEBUG  </parameter> " << std::endl
 		   <<  "  <parameter name=\"RandomSeed\" value=\"1234567890\" />" << std::endl
+		   <<  "  <!-- algorithm for the processor seeds: Philox (default) or JenkinsHash (seeds of previous Marlin versions) -->  " << std::endl
+		   <<  "  <!--parameter name=\"RandomSeedMode\" value=\"Philox\" /-->" << std::endl
 		   <<  "  <!-- optionally limit the collections that are read from the input file: -->  " << std::endl
 		   <<  "  <!--parameter name=\"LCIOReadCollectionNames\">MCParticle PandoraPFOs</parameter-->" << std::endl
+		   <<  "  <!-- print time and memory used by the startup phases (libraries, parser, GEAR, init) and/or write them to a JSON file: -->  " << std::endl
+		   <<  "  <!--parameter name=\"StartupProfile\" value=\"true\" /-->" << std::endl
+		   <<  "  <!--parameter name=\"StartupProfileFile\" value=\"startup.json\" /-->" << std::endl
+		   <<  "  <!-- process the LCIO input with N forked worker processes in chunks of events - output files are merged: -->  " << std::endl
+		   <<  "  <!--parameter name=\"NumberOfProcesses\" value=\"4\" /-->" << std::endl
+		   <<  "  <!--parameter name=\"EventChunkSize\" value=\"10\" /-->" << std::endl
+		   <<  "  <!-- call init() and end() concurrently for processors declared independent (setIndependentInit()): -->  " << std::endl
+		   <<  "  <!--parameter name=\"ParallelInit\" value=\"true\" /-->" << std::endl
+		   <<  "  <!-- initialize processors inside <if> conditions only before the first event they are called for: -->  " << std::endl
+		   <<  "  <!--parameter name=\"LazyInit\" value=\"true\" /-->" << std::endl
+		   <<  "  <!-- don't call processors for events in which all their input collections are missing or empty: -->  " << std::endl
+		   <<  "  <!--parameter name=\"SkipWithoutInputs\" value=\"true\" /-->" << std::endl
 		   <<  " </global>" << std::endl
 		   << std::endl ;
 
@@ -196,6 +422,9 @@ namespace marlin{
 
     std::set< std::string > ProcessorMgr::getAvailableProcessorTypes(){
 
+        if( this != _me )
+            return defaultInstance()->getAvailableProcessorTypes() ;
+
         std::set< std::string > ptypes;
 
         for(ProcessorMap::iterator i=_map.begin() ; i!= _map.end() ; i++) {
@@ -205,6 +434,9 @@ namespace marlin{
     }
 
     Processor* ProcessorMgr::getProcessor( const std::string& type ){
+        if( this != _me )
+            return defaultInstance()->getProcessor( type ) ;
+
         return _map[ type ] ;
     }
 
@@ -216,6 +448,7 @@ namespace marlin{
 
 
         _list.remove( _activeMap[name] ) ;
+        _conditional.erase( _activeMap[name] ) ;
         _activeMap.erase( name ) ;
 
     }
@@ -226,6 +459,8 @@ namespace marlin{
             std::shared_ptr<StringParameters> parameters ,
             const std::string condition) {
 
+        PipelineContext::Scope ctxScope( _context ) ;
+
         Processor* processor = getProcessor( processorType ) ;
 
 
@@ -248,10 +483,20 @@ namespace marlin{
 
             Processor* newProcessor = processor->newProcessor() ;
             newProcessor->setName( processorName ) ;
+            newProcessor->_context = _context ;
             _activeMap[ processorName ] = newProcessor ;
             _list.push_back( newProcessor ) ;
             _conditions.addCondition( processorName, condition ) ;
 
+            // the condition without surrounding white space
+            std::string::size_type first = condition.find_first_not_of( " \t\n" ) ;
+            std::string trimmed = ( first == std::string::npos ? "" :
+                                    condition.substr( first , condition.find_last_not_of( " \t\n" ) - first + 1 ) ) ;
+
+            if( ! trimmed.empty() && trimmed != "true" ) {
+                _conditional.insert( newProcessor ) ;
+            }
+
             if( parameters != 0 ){
                 newProcessor->setParameters( parameters  ) ;
             }
@@ -267,40 +512,265 @@ namespace marlin{
 
     void ProcessorMgr::init(){ 
 
+        PipelineContext::Scope ctxScope( _context ) ;
+
         streamlog::logbuffer* lb = new streamlog::logbuffer( std::cout.rdbuf() ,  &my_cout ) ;
         std::cout.rdbuf(  lb ) ;
 
         //     for_each( _list.begin() , _list.end() , std::mem_fun( &Processor::baseInit ) ) ;
 
+        const bool parallel = parallelInit() ;
+
+        // input collections of the processors that are skipped if all are missing or empty
+        const bool skipAll = ( _context->parameters() != 0 && _context->parameters()->getStringVal("SkipWithoutInputs") == "true" ) ;
+
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
+
+            if( skipAll || (*it)->skipWithoutInputs() ) {
+
+                StringVec names ;
+
+                for( ProcParamMap::iterator itP = (*it)->_map.begin() ; itP != (*it)->_map.end() ; ++itP ) {
+
+                    if( (*it)->isInputCollectionName( itP->first ) ) {
+
+                        std::stringstream values( itP->second->value() ) ;
+                        std::string name ;
+                        while( values >> name )
+                            names.push_back( name ) ;
+                    }
+                }
+                if( ! names.empty() )
+                    _inputCollections[ *it ] = names ;
+            }
+        }
+
+        // processors only called under a condition are initialized for the first event they are called
+        if( _context->parameters() != 0 && _context->parameters()->getStringVal("LazyInit") == "true" ) {
+
+            for( std::set<Processor*>::iterator it = _conditional.begin() ; it != _conditional.end() ; ++it ) {
+
+                if( dynamic_cast<EventModifier*>( *it ) == 0 ) {
+                    _uninitialized.insert( *it ) ;
+                }
+            }
+        }
+
         for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
 	  
+	  if( _uninitialized.count( *it ) ) {
+
+	    _timeMap[ *it ] = std::make_pair( 0 , 0 )  ;
+
+	    streamlog_out( DEBUG5 ) << " init() of conditional processor " << (*it)->name() << " deferred to its first event " << std::endl ;
+	    continue ;
+	  }
+
+	  // independent processors are initialized concurrently
+	  std::vector<Processor*> batch = independentBatch( it , _list.end() , parallel , _uninitialized ) ;
+
+	  if( batch.size() > 1 ) {
+
+	    callConcurrently( batch , &Processor::baseInit , "init" ) ;
+
+	    for( unsigned i=0 ; i < batch.size() ; ++i ) {
+	      processorInitialized( batch[i] ) ;
+	    }
+	    std::advance( it , batch.size() - 1 ) ;
+	    continue ;
+	  }
+
 	  streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
 	  scope.setLevel( (*it)->logLevelName() ) ;
 	  
 	  streamlog::logscope scope1(  my_cout ) ; scope1.setName(  (*it)->name()  ) ;
 	  
+	  StartupProfiler::Phase phase( "init", (*it)->name() ) ;
+
 	  (*it)->baseInit() ;
-	  
-	  tMap[ *it ] = std::make_pair( 0 , 0 )  ;
-	  
-	  
-	  EventModifier* em = dynamic_cast<EventModifier*>( *it ) ; 
-	  
-	  if( em != 0 ) {
-	    
-	    _eventModifierList.push_back( *it ) ;	
-	    
-	    streamlog_out( WARNING4 ) << " -----------   " << std::endl
-				      << " the following processor will modify the LCIO event :  "
-				      << (*it)->name()  << " !! " <<  std::endl
-				      << " ------------  "   << std::endl ; 
-	  }
 
+	  phase.stop() ;
+	  
+	  processorInitialized( *it ) ;
 	}
+
+        // processors initialized concurrently have registered with the seeder in random order
+        if( parallel )
+            _context->eventSeeder()->sortRegistered( std::vector<Processor*>( _list.begin() , _list.end() ) ) ;
+
+        // ---- processors that limit concurrent event processing
+        std::stringstream serial ;
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
+          if( (*it)->concurrency() == Processor::SERIAL_ONLY )
+            serial << " " << (*it)->name() ;
+        }
+        if( ! serial.str().empty() ) {
+          streamlog_out( DEBUG5 ) << " processors declared " << Processor::concurrencyName( Processor::SERIAL_ONLY ) 
+                                  << " :" << serial.str() << std::endl ;
+        }
+    }
+
+
+    void ProcessorMgr::processorInitialized( Processor* proc ) {
+
+        _timeMap[ proc ] = std::make_pair( 0 , 0 )  ;
+
+        EventModifier* em = dynamic_cast<EventModifier*>( proc ) ; 
+
+        if( em != 0 ) {
+
+            _eventModifierList.push_back( proc ) ;	
+
+            streamlog::logscope scope( streamlog::out ) ; scope.setName(  proc->name()  ) ;
+            scope.setLevel( proc->logLevelName() ) ;
+
+            streamlog_out( WARNING4 ) << " -----------   " << std::endl
+                << " the following processor will modify the LCIO event :  "
+                << proc->name()  << " !! " <<  std::endl
+                << " ------------  "   << std::endl ; 
+        }
     }
 
+
+    bool ProcessorMgr::inputsMissing( Processor* proc , LCEvent* evt ) {
+
+        std::map< Processor* , StringVec >::const_iterator itI = _inputCollections.find( proc ) ;
+
+        if( itI == _inputCollections.end() )
+            return false ;
+
+        const StringVec* colNames = evt->getCollectionNames() ;
+
+        for( StringVec::const_iterator it = itI->second.begin() ; it != itI->second.end() ; ++it ) {
+
+            if( std::find( colNames->begin() , colNames->end() , *it ) != colNames->end() &&
+                evt->getCollection( *it )->getNumberOfElements() > 0 )
+                return false ;
+        }
+
+        ++ _noInputMap[ proc->name() ] ;
+        return true ;
+    }
+
+
+    void ProcessorMgr::lazyInit( Processor* proc ) {
+
+        _uninitialized.erase( proc ) ;
+
+        streamlog::logscope scope( streamlog::out ) ; scope.setName(  proc->name()  ) ;
+        scope.setLevel( proc->logLevelName() ) ;
+
+        streamlog::logscope scope1(  my_cout ) ; scope1.setName(  proc->name()  ) ;
+
+        streamlog_out( DEBUG5 ) << " initializing conditional processor " << proc->name() << " for its first event " << std::endl ;
+
+        // the processor may register with the seeder although event processing has started
+        ProcessorEventSeeder* seeder = _context->eventSeeder() ;
+        seeder->_lateInit = true ;
+
+        try{
+            proc->baseInit() ;
+        }
+        catch( ... ) {
+            seeder->_lateInit = false ;
+            throw ;
+        }
+        seeder->_lateInit = false ;
+
+        if( _workerID >= 0 ) {
+            proc->workerStarted( _workerID ) ;
+        }
+
+        // replay the current run header
+        if( _currentRun ) {
+            proc->processRunHeader( _currentRun.get() ) ;
+        }
+    }
+
+
+    bool ProcessorMgr::parallelInit() const {
+
+        return _context->parameters() != 0 && _context->parameters()->getStringVal("ParallelInit") == "true" ;
+    }
+
+
+    void ProcessorMgr::callConcurrently( const std::vector<Processor*>& procs , void (Processor::*method)() ,
+                                         const std::string& phaseName ) {
+
+        std::stringstream names ;
+        for( unsigned i=0 ; i < procs.size() ; ++i ) {
+            names << ( i ? " " : "" ) << procs[i]->name() ;
+        }
+        StartupProfiler::Phase phase( phaseName , "parallel: " + names.str() ) ;
+
+        streamlog_out( DEBUG5 ) << " calling " << phaseName << "() concurrently for: " << names.str() << std::endl ;
+
+        std::vector<std::stringbuf> output( procs.size() ) ;
+        std::vector<std::exception_ptr> errors( procs.size() ) ;
+        std::atomic<unsigned> next( 0 ) ;
+
+        // the output of every processor is buffered and printed in order
+        ThreadOutputBuffer outputBuffer( std::cout.rdbuf() ) ;
+        std::cout.flush() ;
+        std::cout.rdbuf( &outputBuffer ) ;
+
+        auto work = [&]() {
+
+            PipelineContext::Scope ctxScope( _context ) ;
+
+            for( unsigned i = next++ ; i < procs.size() ; i = next++ ) {
+
+                threadOutput = &output[i] ;
+                ConcurrentLogGuard::threadProcessor = procs[i] ;
+
+                try{
+                    ( procs[i]->*method )() ;
+                }
+                catch( ... ) {
+                    errors[i] = std::current_exception() ;
+                }
+                std::cout.flush() ;
+                ConcurrentLogGuard::threadProcessor = nullptr ;
+                threadOutput = nullptr ;
+            }
+        } ;
+
+        unsigned nThreads = std::min< unsigned >( procs.size() , std::max( 1u , std::thread::hardware_concurrency() ) ) ;
+
+        std::vector<std::thread> threads ;
+        for( unsigned i=1 ; i < nThreads ; ++i ) {
+            threads.push_back( std::thread( work ) ) ;
+        }
+        work() ;
+
+        for( unsigned i=0 ; i < threads.size() ; ++i ) {
+            threads[i].join() ;
+        }
+
+        std::cout.rdbuf( outputBuffer.target() ) ;
+
+        phase.stop() ;
+
+        for( unsigned i=0 ; i < procs.size() ; ++i ) {
+
+            streamlog::logscope scope( streamlog::out ) ; scope.setName(  procs[i]->name()  ) ;
+            scope.setLevel( procs[i]->logLevelName() ) ;
+
+            streamlog::logscope scope1(  my_cout ) ; scope1.setName(  procs[i]->name()  ) ;
+
+            std::cout << output[i].str() << std::flush ;
+        }
+
+        for( unsigned i=0 ; i < procs.size() ; ++i ) {
+            if( errors[i] )
+                std::rethrow_exception( errors[i] ) ;
+        }
+    }
+
+
     void ProcessorMgr::processRunHeader( LCRunHeader* run){ 
 
+        PipelineContext::Scope ctxScope( _context ) ;
 
 //#ifdef USE_GEAR
         // check if gear file is consistent with detector model in lcio run header 
@@ -313,7 +783,7 @@ namespace marlin{
 
         try{
 
-            gearDetName = Global::GEAR->getDetectorName()  ; 
+            gearDetName = _context->GEAR()->getDetectorName()  ; 
 
         }
         catch( gear::UnknownParameterException& ){ 
@@ -348,9 +818,18 @@ namespace marlin{
 
 //#endif
 
+        // run scoped resources are re-created for the new run
+        _context->resources()->invalidateRun() ;
+
+        // kept for the processors initialized later in the run - the reader owns the run header
+        _currentRun.reset( copyRunHeader( run ) ) ;
+
         //     for_each( _list.begin() , _list.end() ,  std::bind2nd(  std::mem_fun( &Processor::processRunHeader ) , run ) ) ;
         for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
 	  
+	  if( _uninitialized.count( *it ) )
+	    continue ;
+
 	  streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
 	  scope.setLevel( (*it)->logLevelName() ) ;
 	  
@@ -362,6 +841,8 @@ namespace marlin{
   
   
     void ProcessorMgr::modifyRunHeader( LCRunHeader* rhd ){ 
+
+      PipelineContext::Scope ctxScope( _context ) ;
     
       for( ProcessorList::iterator it = _eventModifierList.begin();  it !=  _eventModifierList.end()  ; ++ it) {
       
@@ -378,11 +859,16 @@ namespace marlin{
     }
 
     void ProcessorMgr::modifyEvent( LCEvent* evt ){ 
+
+      PipelineContext::Scope ctxScope( _context ) ;
     
+      // the event data is kept for processEvent() - unless an exception is thrown
+      EndEventGuard endEvent( _context->eventData() , evt ) ;
+
       _conditions.clear() ;
       
       // refresh the seeds for this event
-      Global::EVENTSEEDER->refreshSeeds( evt ) ;
+      _context->eventSeeder()->refreshSeeds( evt ) ;
 
       for( ProcessorList::iterator it = _eventModifierList.begin();  it !=  _eventModifierList.end()  ; ++ it) {
 
@@ -397,29 +883,29 @@ namespace marlin{
       
         streamlog::logscope scope1(  my_cout ) ; scope1.setName(  (*it)->name()  ) ;
 
-        start_t = clock(); // start timer
+        clock_t startTime = clock(); // start timer
 
         (  dynamic_cast<EventModifier*>( *it )  )->modifyEvent( evt ) ;
 
-        end_t = clock(); // stop timer
+        clock_t endTime = clock(); // stop timer
 
-        TimeMap::iterator itT = tMap.find( *it );
+        TimeMap::iterator itT = _timeMap.find( *it );
 
-        itT->second.first += double( end_t - start_t  );
+        itT->second.first += double( endTime - startTime  );
         //do not increase event count, because this is done after processEvent again
         //itT->second.second++;
 
       }
     
       
-      bool check = ( Global::parameters->getStringVal("SupressCheck") != "true" ) ;
+      bool check = ( _context->parameters()->getStringVal("SupressCheck") != "true" ) ;
 
-      bool modify = ( Global::parameters->getStringVal("AllowToModifyEvent") == "true" ) ;
+      bool modify = ( _context->parameters()->getStringVal("AllowToModifyEvent") == "true" ) ;
       
       if( modify ) {
 	
 	// refresh the seeds for this event
-	Global::EVENTSEEDER->refreshSeeds( evt ) ;
+	_context->eventSeeder()->refreshSeeds( evt ) ;
 	
         try{ 
 	  
@@ -427,24 +913,33 @@ namespace marlin{
 	    
 	    if( _conditions.conditionIsTrue( (*it)->name() ) ) {
 	      
+	      if( ! _inputCollections.empty() && inputsMissing( *it , evt ) )
+		continue ;
+
+	      if( ! _uninitialized.empty() && _uninitialized.count( *it ) )
+		lazyInit( *it ) ;
+
 	      streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
 	      //if( (*it)->logLevelName().size() > 0  )
 	      scope.setLevel( (*it)->logLevelName() ) ;
 	      
 	      streamlog::logscope scope1(  my_cout ) ; scope1.setName(  (*it)->name()  ) ;
 	      
-	      start_t =  clock () ;  // start timer
+	      clock_t startTime = clock () ;  // start timer
 	      
 	      (*it)->processEvent( evt ) ; 
+
+	      if( ( (*it)->_skipRequested || (*it)->_stopRequested ) && eventAborted( *it ) )
+		break ;
 	      
 	      if( check )  (*it)->check( evt ) ;
 	      
-	      end_t =  clock () ;  // stop timer
+	      clock_t endTime = clock () ;  // stop timer
 	      
 	      
-	      TimeMap::iterator itT = tMap.find( *it ) ;
+	      TimeMap::iterator itT = _timeMap.find( *it ) ;
 	      
-	      itT->second.first += double( end_t - start_t  ) ; 
+	      itT->second.first += double( endTime - startTime  ) ; 
 	      itT->second.second ++ ;
 	      
 	      
@@ -458,24 +953,45 @@ namespace marlin{
 	
       } // end modify
 
-
+      endEvent.release() ;
     }
   
 
+    bool ProcessorMgr::eventAborted( Processor* proc ) {
+
+        if( proc->_stopRequested ) {
+            proc->_stopRequested = false ;
+            proc->_skipRequested = false ;
+            throw ProcMgrStopProcessing( proc->name() ) ;
+        }
+
+        proc->_skipRequested = false ;
+        ++ _skipCountMap[ proc ] ;
+
+        return true ;
+    }
+
+
     void ProcessorMgr::processEvent( LCEvent* evt ){ 
 
+        PipelineContext::Scope ctxScope( _context ) ;
+
+        // the event data is not needed any more after this call
+        EndEventGuard endEvent( _context->eventData() , evt ) ;
+
         _conditions.clear() ;
 
-        bool check = ( Global::parameters->getStringVal("SupressCheck") != "true" ) ;
+        bool check = ( _context->parameters()->getStringVal("SupressCheck") != "true" ) ;
 
-        bool modify = ( Global::parameters->getStringVal("AllowToModifyEvent") == "true" ) ;
+        bool modify = ( _context->parameters()->getStringVal("AllowToModifyEvent") == "true" ) ;
 
-	if( modify ) 
+	if( modify ) {
 	  return ;   // processorEventMethods already called in modifyEvent() ...
+	}
 
 
 	// refresh the seeds for this event
-	Global::EVENTSEEDER->refreshSeeds( evt ) ;
+	_context->eventSeeder()->refreshSeeds( evt ) ;
  
         try{ 
 
@@ -483,24 +999,33 @@ namespace marlin{
 
                 if( _conditions.conditionIsTrue( (*it)->name() ) ) {
 
+                    if( ! _inputCollections.empty() && inputsMissing( *it , evt ) )
+                        continue ;
+
+                    if( ! _uninitialized.empty() && _uninitialized.count( *it ) )
+                        lazyInit( *it ) ;
+
                     streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
 		    //if( (*it)->logLevelName().size() > 0  )
 		    scope.setLevel( (*it)->logLevelName() ) ;
 		    
                     streamlog::logscope scope1(  my_cout ) ; scope1.setName(  (*it)->name()  ) ;
 
-                    start_t =  clock () ;  // start timer
+                    clock_t startTime = clock () ;  // start timer
 
 		    (*it)->processEvent( evt ) ; 
 
+                    if( ( (*it)->_skipRequested || (*it)->_stopRequested ) && eventAborted( *it ) )
+                        break ;
+
                     if( check )  (*it)->check( evt ) ;
 
-                    end_t =  clock () ;  // stop timer
+                    clock_t endTime = clock () ;  // stop timer
 
 
-                    TimeMap::iterator itT = tMap.find( *it ) ;
+                    TimeMap::iterator itT = _timeMap.find( *it ) ;
 
-                    itT->second.first += double( end_t - start_t  ) ; 
+                    itT->second.first += double( endTime - startTime  ) ; 
                     itT->second.second ++ ;
 
 
@@ -528,25 +1053,103 @@ namespace marlin{
 
     void ProcessorMgr::end(){ 
 
+        PipelineContext::Scope ctxScope( _context ) ;
+
         //     for_each( _list.begin() , _list.end() ,  std::mem_fun( &Processor::end ) ) ;
 
         //    for_each( _list.rbegin() , _list.rend() ,  std::mem_fun( &Processor::end ) ) ;
 
+        const bool parallel = ( _nWorkers == 0 && parallelInit() ) ;
+
+        // processors never called - the main process of the multi-process mode needs all
+        // processors initialized to merge the output of the workers
+        if( ! _uninitialized.empty() ) {
+
+            std::stringstream names ;
+            for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
+                if( _uninitialized.count( *it ) )
+                    names << " " << (*it)->name() ;
+            }
+            streamlog_out( MESSAGE ) << " conditional processors never called (not initialized) :" << names.str() << std::endl ;
+
+            if( _nWorkers > 0 ) {
+                while( ! _uninitialized.empty() )
+                    lazyInit( *_uninitialized.begin() ) ;
+            }
+        }
+
         for( ProcessorList::reverse_iterator it = _list.rbegin() ; it != _list.rend() ; ++it ) {
 
+            if( _uninitialized.count( *it ) )
+                continue ;
+
+            // independent processors are ended concurrently
+            std::vector<Processor*> batch = independentBatch( it , _list.rend() , parallel , _uninitialized ) ;
+
+            if( batch.size() > 1 ) {
+
+                callConcurrently( batch , &Processor::end , "end" ) ;
+
+                std::advance( it , batch.size() - 1 ) ;
+                continue ;
+            }
+
             streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
 	    scope.setLevel( (*it)->logLevelName() ) ;
 
             streamlog::logscope scope1(  my_cout ) ; scope1.setName(  (*it)->name()  ) ;
 
-            (*it)->end() ;
+            if( _nWorkers > 0 )
+                (*it)->mergeWorkerOutput( _nWorkers ) ;
+            else
+                (*it)->end() ;
+        }
+
+        // the main process prints the statistics of all workers
+        if( _workerID < 0 ) {
+            printStatistics() ;
         }
+
+        delete _context->_seeder ;
+        _context->_seeder = nullptr ;
+
+        for (auto& pair : _activeMap ) {
+          delete pair.second;
+        }
+
+        _activeMap.clear();
+        _map.clear();
+        _list.clear();
+
+        // processors are deleted - resources are not used any more
+        delete _context->_resources ;
+        _context->_resources = nullptr ;
+
+        delete _context->_eventData ;
+        _context->_eventData = nullptr ;
+
+        // the manager of a non-default pipeline is owned by its PipelineContext
+        if( this == _me ) {
+          delete _me;
+          _me = nullptr;
+        }
+
+    }
+
+    void ProcessorMgr::printStatistics() {
+
         //     if( _skipMap.size() > 0 ) {
         streamlog_out(MESSAGE)  << " --------------------------------------------------------- " << std::endl
             << "  Events skipped by processors : " << std::endl ;
 
+        // events skipped with Processor::skipEvent() and SkipEventException
+        SkippedEventMap skipMap( _skipMap ) ;
+        for( std::map< Processor* , int >::iterator it = _skipCountMap.begin() ; it != _skipCountMap.end() ; it++) {
+            skipMap[ it->first->name() ] += it->second ;
+        }
+
         unsigned nSkipped = 0 ;
-        for( SkippedEventMap::iterator it = _skipMap.begin() ; it != _skipMap.end() ; it++) {
+        for( SkippedEventMap::iterator it = skipMap.begin() ; it != skipMap.end() ; it++) {
 
             streamlog_out(MESSAGE) << "       " << it->first << ": \t" <<  it->second << std::endl ;
 
@@ -558,6 +1161,19 @@ namespace marlin{
             << std::endl ;
         //     }
 
+        if( ! _noInputMap.empty() ) {
+
+            streamlog_out(MESSAGE)  << " --------------------------------------------------------- " << std::endl
+                << "  Processors not called - input collections missing or empty : " << std::endl ;
+
+            for( SkippedEventMap::iterator it = _noInputMap.begin() ; it != _noInputMap.end() ; it++) {
+                streamlog_out(MESSAGE) << "       " << it->first << ": \t" <<  it->second << std::endl ;
+            }
+            streamlog_out(MESSAGE)  << " --------------------------------------------------------- "  
+                << std::endl
+                << std::endl ;
+        }
+
         // ----- print timing information ----------
 
         streamlog_out(MESSAGE)  << " --------------------------------------------------------- " << std::endl
@@ -569,12 +1185,12 @@ namespace marlin{
 
 
         //    for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
-        //      TimeMap::iterator itT = tMap.find( *it ) ;
+        //      TimeMap::iterator itT = _timeMap.find( *it ) ;
 
         // sort procs wrt processing time :
         typedef std::list< TimeMap::value_type > TMList  ;
         TMList l ;
-        std::copy(  tMap.begin() , tMap.end() , std::back_inserter( l ) )  ;
+        std::copy(  _timeMap.begin() , _timeMap.end() , std::back_inserter( l ) )  ;
         l.sort( Cmp() ) ; 
 
         double tTotal = 0.0 ;
@@ -633,23 +1249,113 @@ namespace marlin{
 
 
         streamlog_out(MESSAGE) << " --------------------------------------------------------- "  << std::endl ;
+    }
 
-        delete Global::EVENTSEEDER ;
-        Global::EVENTSEEDER = nullptr ;
 
-        for (auto& pair : _activeMap ) {
-          delete pair.second;
+    bool ProcessorMgr::allowWorkerProcesses() const {
+
+        for( ProcessorList::const_iterator it = _list.begin() ; it != _list.end() ; ++it ) {
+
+            if( ! (*it)->allowWorkerProcesses() ) {
+
+                streamlog_out( WARNING ) << " processor " << (*it)->name() << " ( " << (*it)->type() 
+                    << " ) can't run in worker processes " << std::endl ;
+                return false ;
+            }
         }
+        return true ;
+    }
 
-        _activeMap.clear();
-        _map.clear();
-        _list.clear();
 
-        delete _me;
-        _me = nullptr;
+    void ProcessorMgr::workerStarted( int workerID ) {
+
+        PipelineContext::Scope ctxScope( _context ) ;
 
+        _workerID = workerID ;
+
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
+
+            // called in lazyInit() for the others
+            if( _uninitialized.count( *it ) )
+                continue ;
+
+            streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
+            scope.setLevel( (*it)->logLevelName() ) ;
+
+            (*it)->workerStarted( workerID ) ;
+        }
+    }
+
+
+    void ProcessorMgr::writeStatistics( std::ostream& out ) const {
+
+        for( SkippedEventMap::const_iterator it = _skipMap.begin() ; it != _skipMap.end() ; ++it ) {
+            out << "skip " << it->second << " " << it->first << "\n" ;
+        }
+        for( std::map< Processor* , int >::const_iterator it = _skipCountMap.begin() ; it != _skipCountMap.end() ; ++it ) {
+            out << "skip " << it->second << " " << it->first->name() << "\n" ;
+        }
+        for( SkippedEventMap::const_iterator it = _noInputMap.begin() ; it != _noInputMap.end() ; ++it ) {
+            out << "noinput " << it->second << " " << it->first << "\n" ;
+        }
+        for( TimeMap::const_iterator it = _timeMap.begin() ; it != _timeMap.end() ; ++it ) {
+            out << "time " << std::setprecision(17) << it->second.first << " " << it->second.second 
+                << " " << it->first->name() << "\n" ;
+        }
+    }
+
+
+    void ProcessorMgr::addStatistics( std::istream& in ) {
+
+        std::string key ;
+
+        while( in >> key ) {
+
+            std::string name ;
+
+            if( key == "skip" ) {
+
+                int n = 0 ;
+                in >> n >> std::ws ;
+                std::getline( in , name ) ;
+
+                _skipMap[ name ] += n ;
+            }
+            else if( key == "noinput" ) {
+
+                int n = 0 ;
+                in >> n >> std::ws ;
+                std::getline( in , name ) ;
+
+                _noInputMap[ name ] += n ;
+            }
+            else if( key == "time" ) {
+
+                double t = 0. ;
+                int n = 0 ;
+                in >> t >> n >> std::ws ;
+                std::getline( in , name ) ;
+
+                ProcessorMap::iterator itP = _activeMap.find( name ) ;
+
+                if( itP != _activeMap.end() ) {
+                    _timeMap[ itP->second ].first += t ;
+                    _timeMap[ itP->second ].second += n ;
+                }
+            }
+            else {
+                std::getline( in , name ) ;
+            }
+        }
+    }
+
+
+    void ProcessorMgr::endWorkers( int nWorkers ) {
+
+        _nWorkers = nWorkers ;
+
+        end() ;
     }
 
-  
 
     } // namespace marlin
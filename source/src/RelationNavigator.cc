@@ -0,0 +1,98 @@
+#include "marlin/RelationNavigator.h"
+#include "marlin/EventDataService.h"
+#include "marlin/Exceptions.h"
+#include "marlin/PipelineContext.h"
+
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCParameters.h"
+#include "EVENT/LCRelation.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+
+namespace marlin{
+
+  std::shared_ptr<const RelationNavigator> RelationNavigator::get( EVENT::LCEvent* evt, const std::string& colName,
+								   Direction direction ) {
+
+    return PipelineContext::current()->eventData()->get<RelationNavigator>( evt,
+									     std::string( direction == FROM_TO ? "RelationNavigator:FromTo:" : "RelationNavigator:ToFrom:" ) + colName,
+									     [&](){ return new RelationNavigator( evt->getCollection( colName ), direction ) ; } ) ;
+  }
+
+
+  RelationNavigator::RelationNavigator( const EVENT::LCCollection* col, Direction direction ) :
+    _direction( direction ) {
+
+    if( col->getTypeName() != lcio::LCIO::LCRELATION )
+      throw Exception( "RelationNavigator: collection of type " + col->getTypeName() + " is not an LCRelation collection" ) ;
+
+    const std::string& fromType = col->getParameters().getStringVal( "FromType" ) ;
+    const std::string& toType = col->getParameters().getStringVal( "ToType" ) ;
+
+    _sourceType = ( direction == FROM_TO ? fromType : toType ) ;
+    _relatedType = ( direction == FROM_TO ? toType : fromType ) ;
+
+    const size_t n = col->getNumberOfElements() ;
+
+    std::vector<const EVENT::LCObject*> sources( n ) ;
+    std::vector<EVENT::LCObject*> related( n ) ;
+    std::vector<float> weights( n ) ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const EVENT::LCRelation* rel = static_cast<const EVENT::LCRelation*>( col->getElementAt( i ) ) ;
+
+      sources[i] = ( direction == FROM_TO ? rel->getFrom() : rel->getTo() ) ;
+      related[i] = ( direction == FROM_TO ? rel->getTo() : rel->getFrom() ) ;
+      weights[i] = rel->getWeight() ;
+    }
+
+    // stable - the related objects of a source keep the order of the collection
+    std::vector<size_t> order( n ) ;
+    std::iota( order.begin(), order.end(), 0 ) ;
+    std::stable_sort( order.begin(), order.end(), [&]( size_t a, size_t b ){ return std::less<const EVENT::LCObject*>()( sources[a], sources[b] ) ; } ) ;
+
+    _sources.reserve( n ) ;
+    _related.reserve( n ) ;
+    _weights.reserve( n ) ;
+
+    // relations of the same pair of objects are merged into the first one and their weights
+    // are summed - as in UTIL::LCRelationNavigator
+    std::unordered_map< EVENT::LCObject*, size_t > position ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const size_t k = order[i] ;
+
+      if( i == 0 || sources[k] != _sources.back() )
+	position.clear() ;
+
+      std::pair< std::unordered_map< EVENT::LCObject*, size_t >::iterator, bool > r = position.emplace( related[k], _related.size() ) ;
+
+      if( ! r.second ) {
+	_weights[ r.first->second ] += weights[k] ;
+	continue ;
+      }
+
+      _sources.push_back( sources[k] ) ;
+      _related.push_back( related[k] ) ;
+      _weights.push_back( weights[k] ) ;
+    }
+  }
+
+
+  RelationNavigator::Range RelationNavigator::related( const EVENT::LCObject* obj ) const {
+
+    std::pair< std::vector<const EVENT::LCObject*>::const_iterator, std::vector<const EVENT::LCObject*>::const_iterator > r =
+      std::equal_range( _sources.begin(), _sources.end(), obj, std::less<const EVENT::LCObject*>() ) ;
+
+    const size_t first = r.first - _sources.begin() ;
+
+    return Range( _related.data() + first, _weights.data() + first, r.second - r.first ) ;
+  }
+
+}
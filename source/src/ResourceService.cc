@@ -0,0 +1,58 @@
+#include "marlin/ResourceService.h"
+
+namespace marlin{
+
+  std::shared_ptr<ResourceService::Entry> ResourceService::entry( const std::string& name, const std::type_info& type, Scope scope ) {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    std::shared_ptr<Entry>& e = _entries[ name ] ;
+
+    if( ! e ) {
+      e = std::make_shared<Entry>( type, scope ) ;
+    }
+    else if( e->type != std::type_index( type ) || e->scope != scope ) {
+      throw Exception( std::string("ResourceService: resource ") + name
+		       + " already registered with a different type or scope" ) ;
+    }
+    return e ;
+  }
+
+
+  bool ResourceService::exists( const std::string& name ) const {
+
+    std::shared_ptr<Entry> e ;
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+
+      auto it = _entries.find( name ) ;
+      if( it == _entries.end() )
+	return false ;
+      e = it->second ;
+    }
+    std::lock_guard<std::mutex> lock( e->mutex ) ;
+    return bool( e->resource ) ;
+  }
+
+
+  void ResourceService::invalidateRun() {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    for( auto it = _entries.begin() ; it != _entries.end() ; ) {
+
+      if( it->second->scope == RUN )
+	it = _entries.erase( it ) ;
+      else
+	++it ;
+    }
+  }
+
+
+  void ResourceService::clear() {
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    _entries.clear() ;
+  }
+
+}
@@ -4,6 +4,8 @@
 
 #include "marlin/SimpleClusterSmearer.h"
 
+#include "marlin/ZigguratGaussian.h"
+
 #include "CLHEP/Random/RandGauss.h"
 #include "CLHEP/Random/RandEngine.h"
 #include <cmath>
@@ -33,6 +35,12 @@ namespace marlin{
       
       _resVec.push_back( ClusterResolution( A, B , thMin, thMax ) );
     }
+
+    std::vector< std::pair<double,double> > ranges ;
+    for( unsigned int i=0 ; i < _resVec.size() ; i++ )
+      ranges.push_back( std::make_pair( _resVec[i].ThMin, _resVec[i].ThMax ) ) ;
+
+    _bins.init( ranges ) ;
   }
   
   
@@ -46,13 +54,11 @@ namespace marlin{
       
     std::pair<double,double> resolution = std::make_pair( -1., -1. ) ; 
     
-    for( unsigned int i=0 ; i <  _resVec.size() ; i++ ){
+    const int iRes = resolutionIndex( theta ) ;
 
-      if( theta <= _resVec[i].ThMax  &&  theta > _resVec[i].ThMin ) {
-	resolution.first =  _resVec[i].A ;
-	resolution.second =  _resVec[i].B ;
-	break ;
-      }
+    if( iRes >= 0 ) {
+      resolution.first =  _resVec[ iRes ].A ;
+      resolution.second =  _resVec[ iRes ].B ;
     }
     HepLorentzVector sv( 0., 0. , 0., 0. ) ;
     
@@ -83,6 +89,66 @@ namespace marlin{
     return sv ;
 
   }
+
+
+  void SimpleClusterSmearer::smearFourVectors( FourVectorArrays& v ) {
+
+    const size_t n = v.size ;
+
+    // ---- resolutions first - random numbers are only drawn for the clusters with a resolution
+    std::vector<double> sigma( n, 0. ) ;
+    std::vector<char> smeared( n, 0 ) ;
+    size_t nSmeared = 0 ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const double pT = std::sqrt( v.px[i] * v.px[i] + v.py[i] * v.py[i] ) ;
+      double theta = ( pT == 0. && v.pz[i] == 0. ? 0. : std::atan2( pT, v.pz[i] ) ) ;
+
+      if( theta > M_PI_2 )  theta = M_PI - theta ;
+
+      const int iRes = resolutionIndex( theta ) ;
+
+      if( iRes >= 0 && _resVec[ iRes ].A > - 1e-10 ) {
+
+	const double A = _resVec[ iRes ].A ;
+	const double B = _resVec[ iRes ].B ;
+	const double E = v.e[i] ;
+
+	sigma[i] = E * std::sqrt( A * A + B * B / E ) ;
+	smeared[i] = 1 ;
+	++nSmeared ;
+      }
+    }
+
+    std::vector<double> gauss( nSmeared ) ;
+
+    if( nSmeared > 0 && v.random != 0 )
+      ZigguratGaussian::shootArray( *v.random, nSmeared, &gauss[0] ) ;
+    else if( nSmeared > 0 )
+      RandGauss::shootArray( nSmeared, &gauss[0] ) ;
+
+    // ---- smearing - massless clusters
+    for( size_t i=0, k=0 ; i < n ; ++i ) {
+
+      if( ! smeared[i] ) {
+	v.px[i] = v.py[i] = v.pz[i] = v.e[i] = 0. ;
+	continue ;
+      }
+
+      const double P = std::sqrt( v.px[i] * v.px[i] + v.py[i] * v.py[i] + v.pz[i] * v.pz[i] ) ;
+      const double deltaE = gauss[ k++ ] * sigma[i] ;
+
+      if( P > 0. ) {
+	const double scale = ( v.e[i] + deltaE ) / P ;
+	v.px[i] *= scale ;
+	v.py[i] *= scale ;
+	v.pz[i] *= scale ;
+      }
+
+      v.e[i] = std::sqrt( v.px[i] * v.px[i] + v.py[i] * v.py[i] + v.pz[i] * v.pz[i] ) ;
+    }
+  }
   
 }
 
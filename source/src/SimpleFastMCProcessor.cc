@@ -7,6 +7,11 @@
 #include "marlin/SimpleClusterSmearer.h"
 #include "marlin/FastMCParticleType.h"
 #include "marlin/ErrorOfSigma.h"
+#include "marlin/CollectionView.h"
+#include "marlin/RelationNavigator.h"
+#include "marlin/ProcessorEventSeeder.h"
+#include "marlin/PipelineContext.h"
+#include "marlin/Exceptions.h"
 
 
 //--- LCIO headers 
@@ -32,7 +37,15 @@
 #endif // MARLIN_AIDA
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace lcio ;
 
@@ -115,6 +128,26 @@ namespace marlin{
 				_initNeutralHadronRes ,
 				hadronResDefault ,
 				hadronResDefault.size() ) ;
+
+    registerProcessorParameter( "ResolutionFile" , 
+				"File with resolution maps - replaces the resolutions of the particle types in the file"  ,
+				_resolutionFile ,
+				std::string("") ) ;
+
+    registerProcessorParameter( "BatchMode" , 
+				"Smear the particles of the event in one batch per particle type"  ,
+				_batchMode ,
+				bool( false ) ) ;
+
+    registerProcessorParameter( "ChunkSize" , 
+				"Number of particles per chunk in BatchMode - 0 for one chunk per event. The results depend on the chunk size"  ,
+				_chunkSize ,
+				int( 1000 ) ) ;
+
+    registerProcessorParameter( "NumberOfThreads" , 
+				"Number of threads for the chunks of an event - larger than one implies BatchMode"  ,
+				_nThreads ,
+				int( 1 ) ) ;
  
 
 
@@ -133,6 +166,20 @@ namespace marlin{
 
     _factory = 0 ;
 
+    if( ! _resolutionFile.empty() )
+      readResolutionFile( _resolutionFile ) ;
+
+    if( _nThreads > 1 && ! _batchMode ) {
+
+      streamlog_out( WARNING ) << " SimpleFastMCProcessor: NumberOfThreads " << _nThreads
+			       << " requires BatchMode - enabling it " << std::endl ;
+      _batchMode = true ;
+    }
+
+    // random numbers for the batch mode
+    if( _batchMode )
+      context()->eventSeeder()->registerProcessor( this ) ;
+
 #ifdef MARLIN_CLHEP
 
     SimpleParticleFactory* simpleFactory  =  new SimpleParticleFactory() ; 
@@ -148,6 +195,168 @@ namespace marlin{
 
 #endif // MARLIN_CLHEP
 
+    // the default smearing draws from the global CLHEP engine
+    if( _nThreads > 1 && ( _factory == 0 || ! _factory->supportsConcurrentSmearing() ) ) {
+
+      streamlog_out( WARNING ) << " SimpleFastMCProcessor: the particle factory does not support concurrent smearing"
+			       << " - using one thread instead of " << _nThreads << std::endl ;
+      _nThreads = 1 ;
+    }
+  }
+
+
+  void SimpleFastMCProcessor::readResolutionFile( const std::string& fileName ) {
+
+    std::ifstream in( fileName.c_str() ) ;
+
+    if( ! in.good() )
+      throw Exception( "SimpleFastMCProcessor: cannot open resolution file " + fileName ) ;
+
+    std::map< std::string, FloatVec* > resolutions ;
+    resolutions[ "ChargedResolution" ] = &_initChargedRes ;
+    resolutions[ "PhotonResolution" ] = &_initPhotonRes ;
+    resolutions[ "NeutralHadronResolution" ] = &_initNeutralHadronRes ;
+
+    // number of values per range
+    std::map< std::string, unsigned > nValues ;
+    nValues[ "ChargedResolution" ] = 3 ;
+    nValues[ "PhotonResolution" ] = 4 ;
+    nValues[ "NeutralHadronResolution" ] = 4 ;
+
+    std::map< std::string, FloatVec > read ;
+    std::string line ;
+    unsigned lineNumber = 0 ;
+
+    while( std::getline( in, line ) ) {
+
+      ++lineNumber ;
+
+      std::istringstream is( line ) ;
+      std::string name ;
+
+      if( ! ( is >> name ) || name[0] == '#' )
+	continue ;
+
+      if( resolutions.find( name ) == resolutions.end() )
+	throw Exception( "SimpleFastMCProcessor: unknown resolution " + name + " in " + fileName ) ;
+
+      FloatVec values ;
+      float value ;
+      while( is >> value )
+	values.push_back( value ) ;
+
+      if( ! is.eof() || values.size() != nValues[ name ] ) {
+	std::stringstream err ;
+	err << "SimpleFastMCProcessor: invalid line " << lineNumber << " in " << fileName
+	    << " - expected " << nValues[ name ] << " values for " << name ;
+	throw Exception( err.str() ) ;
+      }
+
+      FloatVec& res = read[ name ] ;
+      res.insert( res.end(), values.begin(), values.end() ) ;
+    }
+
+    for( std::map< std::string, FloatVec >::const_iterator it = read.begin() ; it != read.end() ; ++it ) {
+
+      *resolutions[ it->first ] = it->second ;
+
+      streamlog_out( MESSAGE ) << " SimpleFastMCProcessor: read " << it->second.size() / nValues[ it->first ]
+			       << " polar angle ranges for " << it->first << " from " << fileName << std::endl ;
+    }
+  }
+
+
+  void SimpleFastMCProcessor::createInChunks( IRecoParticleFactory* factory, const RandomStream& stream,
+					      size_t chunkSize, unsigned nThreads,
+					      const std::vector<const MCParticle*>& mcps,
+					      std::vector<ReconstructedParticle*>& recs ) {
+
+    const size_t n = mcps.size() ;
+
+    if( n == 0 )
+      return ;
+
+    // the chunks and their random streams only depend on the event - not on the threads
+    const size_t size = ( chunkSize > 0 ? chunkSize : n ) ;
+    const size_t nChunks = ( n + size - 1 ) / size ;
+
+    auto chunkStream = [&]( size_t c ) {
+      return ( chunkSize > 0 ? stream.substream( c ) : stream ) ;
+    } ;
+
+    // ---- without concurrent smearing the factory creates the particles chunk by chunk
+    if( ! factory->supportsConcurrentSmearing() ) {
+
+      try{
+	for( size_t c=0 ; c < nChunks ; ++c ) {
+
+	  RandomStream random = chunkStream( c ) ;
+
+	  factory->createReconstructedParticles( &mcps[ c * size ], std::min( size, n - c * size ),
+						 &recs[ c * size ], &random ) ;
+	}
+      }
+      catch( ... ) {
+
+	// the particles are not owned by a collection yet
+	for( size_t i=0 ; i < n ; ++i ) {
+	  delete recs[i] ;
+	  recs[i] = 0 ;
+	}
+	throw ;
+      }
+      return ;
+    }
+
+    // ---- the worker threads only smear the four vectors - no LCIO objects are created
+    std::vector<SmearedParticles> smeared( nChunks ) ;
+    std::vector<std::exception_ptr> errors( nChunks ) ;
+    std::atomic<size_t> next( 0 ) ;
+
+    auto work = [&]() {
+
+      for( size_t c = next++ ; c < nChunks ; c = next++ ) {
+
+	RandomStream random = chunkStream( c ) ;
+
+	try{
+	  factory->smearParticles( &mcps[ c * size ], std::min( size, n - c * size ), smeared[c], &random ) ;
+	}
+	catch( ... ) {
+	  errors[c] = std::current_exception() ;
+	}
+      }
+    } ;
+
+    const size_t threadCount = std::min< size_t >( nChunks, std::max( 1u, nThreads ) ) ;
+
+    std::vector<std::thread> threads ;
+    for( size_t i=1 ; i < threadCount ; ++i )
+      threads.push_back( std::thread( work ) ) ;
+
+    work() ;
+
+    for( size_t i=0 ; i < threads.size() ; ++i )
+      threads[i].join() ;
+
+    for( size_t c=0 ; c < nChunks ; ++c ) {
+      if( errors[c] )
+	std::rethrow_exception( errors[c] ) ;
+    }
+
+    // ---- the ReconstructedParticles are created on the calling thread in input order
+    try{
+      for( size_t c=0 ; c < nChunks ; ++c )
+	factory->createParticles( &mcps[ c * size ], std::min( size, n - c * size ), smeared[c], &recs[ c * size ] ) ;
+    }
+    catch( ... ) {
+
+      for( size_t i=0 ; i < n ; ++i ) {
+	delete recs[i] ;
+	recs[i] = 0 ;
+      }
+      throw ;
+    }
   }
 
 
@@ -158,31 +367,52 @@ namespace marlin{
 
   void SimpleFastMCProcessor::processEvent( LCEvent * evt ) { 
     
-    const LCCollection* mcpCol = evt->getCollection( _inputCollectionName ) ;
+    // the collection type is checked once - no dynamic_cast per particle
+    CollectionView<MCParticle> mcps( evt->getCollection( _inputCollectionName ) ) ;
 
     LCCollectionVec* recVec = new LCCollectionVec( LCIO::RECONSTRUCTEDPARTICLE ) ;
 
     LCRelationNavigator relNav( LCIO::RECONSTRUCTEDPARTICLE , LCIO::MCPARTICLE ) ;
 
-    for(int i=0; i<mcpCol->getNumberOfElements() ; i++){
-      
-      MCParticle* mcp = dynamic_cast<MCParticle*> ( mcpCol->getElementAt( i ) ) ;
-      
-      //      if( mcp->getDaughters().size() == 0 ) { // stable particles only 
+    if( _batchMode && _factory != 0 ) {
+
+      std::vector<const MCParticle*> stable ;
+      stable.reserve( mcps.size() ) ;
+
+      for( MCParticle* mcp : mcps ){
+	if( mcp->getGeneratorStatus() == 1 ) // stable particles only 
+	  stable.push_back( mcp ) ;
+      }
+
+      std::vector<ReconstructedParticle*> recs( stable.size(), 0 ) ;
+
+      createInChunks( _factory, context()->eventSeeder()->getRandomStream( this ),
+		      size_t( std::max( 0, _chunkSize ) ), unsigned( std::max( 1, _nThreads ) ), stable, recs ) ;
+
+      for( size_t i=0 ; i < stable.size() ; ++i ) {
+	if( recs[i] != 0 ) {
+	  recVec->addElement( recs[i] ) ;
+	  relNav.addRelation( recs[i] , const_cast<MCParticle*>( stable[i] ) ) ;
+	}
+      }
+    }
+    else {
+
+      for( MCParticle* mcp : mcps ){
 
-      if( mcp->getGeneratorStatus() == 1 ) { // stable particles only 
+	if( mcp->getGeneratorStatus() == 1 ) { // stable particles only 
 
-	ReconstructedParticle*  rec = 0 ;
+	  ReconstructedParticle*  rec = 0 ;
 	
-	if( _factory != 0 ) 
-	  rec = _factory->createReconstructedParticle( mcp ) ;
+	  if( _factory != 0 ) 
+	    rec = _factory->createReconstructedParticle( mcp ) ;
       
-	if( rec != 0 ) {
-	  recVec->addElement( rec ) ;
-	  relNav.addRelation( rec , mcp ) ;
+	  if( rec != 0 ) {
+	    recVec->addElement( rec ) ;
+	    relNav.addRelation( rec , mcp ) ;
+	  }
 	}
       }
-
     }
     recVec->setDefault( true ) ;
 
@@ -260,7 +490,8 @@ namespace marlin{
       return ;
     }
     
-    LCRelationNavigator relNav( relCol ) ;
+    // the navigator is shared with the other processors of the event
+    std::shared_ptr<const RelationNavigator> relNav = RelationNavigator::get( evt , _mcTruthCollectionName , RelationNavigator::FROM_TO ) ;
     
     if( recCol != 0 ){
       
@@ -270,7 +501,7 @@ namespace marlin{
 	
 	ReconstructedParticle* rec = dynamic_cast<ReconstructedParticle*>( recCol->getElementAt( i ) ) ;
 	
-	const LCObjectVec&  mcps = relNav.getRelatedToObjects( rec ) ;
+	RelationNavigator::Range mcps = relNav->related( rec ) ;
 	
 	MCParticle* mcp = dynamic_cast<MCParticle*>( mcps[0] ) ; // we have a 1-1 relation here 
 	
@@ -2,7 +2,9 @@
 
 #ifdef MARLIN_CLHEP  // only if CLHEP is available !
 
+#include <cmath>
 #include <cstdlib>
+#include <vector>
 
 #include "marlin/SimpleParticleFactory.h"
 
@@ -125,21 +127,141 @@ namespace marlin{
 
     reco4v = sm->smearedFourVector( mc4V , mcp->getPDG() ) ;
    
-    
+    return createParticle( mcp, type, reco4v.px(), reco4v.py(), reco4v.pz(), reco4v.e() ) ;
+  }
+
+
+  void SimpleParticleFactory::createReconstructedParticles( const MCParticle* const* mcps, size_t n,
+							    ReconstructedParticle** recs,
+							    RandomStream* random ) {
+    SmearedParticles s ;
+
+    smearParticles( mcps, n, s, random ) ;
+
+    createParticles( mcps, n, s, recs ) ;
+  }
+
+
+  bool SimpleParticleFactory::supportsConcurrentSmearing() const {
+
+    for( unsigned t=0 ; t < _smearingVec.size() ; ++t ) {
+      if( _smearingVec[t] != 0 && ! _smearingVec[t]->usesRandomStream() )
+	return false ;
+    }
+    return true ;
+  }
+
+
+  void SimpleParticleFactory::smearParticles( const MCParticle* const* mcps, size_t n,
+					      SmearedParticles& s, RandomStream* random ) {
+
+    // ---- classify the particles - the four vectors of one type are contiguous
+    std::vector<FastMCParticleType> types( n ) ;
+    std::vector<size_t> start( NUMBER_OF_FASTMCPARTICLETYPES + 1, 0 ) ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+      types[i] = getParticleType( mcps[i] ) ;
+      ++start[ types[i] + 1 ] ;
+    }
+    for( unsigned t=0 ; t < NUMBER_OF_FASTMCPARTICLETYPES ; ++t )
+      start[ t + 1 ] += start[ t ] ;
+
+    std::vector<double> px( n ), py( n ), pz( n ), e( n ) ;
+    std::vector<int> pdg( n ) ;
+    std::vector<size_t> slot( n ) ;
+    std::vector<size_t> pos( start.begin(), start.end() - 1 ) ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const size_t k = pos[ types[i] ]++ ;
+      const double* p = mcps[i]->getMomentum() ;
+
+      slot[i] = k ;
+      px[k] = p[0] ;
+      py[k] = p[1] ;
+      pz[k] = p[2] ;
+      e[k] = mcps[i]->getEnergy() ;
+      pdg[k] = mcps[i]->getPDG() ;
+    }
+
+    // ---- smear the four vectors of every type in one batch
+    for( unsigned t=0 ; t < NUMBER_OF_FASTMCPARTICLETYPES ; ++t ) {
+
+      if( _smearingVec[t] == 0 || start[ t + 1 ] == start[t] )
+	continue ;
+
+      FourVectorArrays v ;
+      v.size = start[ t + 1 ] - start[t] ;
+      v.px = &px[ start[t] ] ;
+      v.py = &py[ start[t] ] ;
+      v.pz = &pz[ start[t] ] ;
+      v.e = &e[ start[t] ] ;
+      v.pdg = &pdg[ start[t] ] ;
+
+      // independent of the number of particles of the other types
+      RandomStream typeStream ;
+
+      if( random != 0 ) {
+	typeStream = random->substream( t ) ;
+	v.random = &typeStream ;
+      }
+
+      _smearingVec[t]->smearFourVectors( v ) ;
+    }
+
+    // ---- back to input order
+    s.type.resize( n ) ;
+    s.px.resize( n ) ;
+    s.py.resize( n ) ;
+    s.pz.resize( n ) ;
+    s.e.resize( n ) ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const size_t k = slot[i] ;
+
+      s.type[i] = ( _smearingVec[ types[i] ] != 0 ? int( types[i] ) : -1 ) ;
+      s.px[i] = px[k] ;
+      s.py[i] = py[k] ;
+      s.pz[i] = pz[k] ;
+      s.e[i] = e[k] ;
+    }
+  }
+
+
+  void SimpleParticleFactory::createParticles( const MCParticle* const* mcps, size_t n,
+					       const SmearedParticles& s, ReconstructedParticle** recs ) {
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      recs[i] = ( s.type[i] >= 0 ?
+		  createParticle( mcps[i], FastMCParticleType( s.type[i] ), s.px[i], s.py[i], s.pz[i], s.e[i] ) : 0 ) ;
+    }
+  }
+
+
+  ReconstructedParticle* SimpleParticleFactory::createParticle( const MCParticle* mcp, FastMCParticleType type,
+								double px, double py, double pz, double e ) const {
+
     ReconstructedParticleImpl* rec = 0 ;
+
+    const double p2 = px * px + py * py + pz * pz ;
     
-    if(  reco4v.vect().mag() >  _momentumCut  ) {  
+    if(  std::sqrt( p2 ) >  _momentumCut  ) {  
       
       rec = new ReconstructedParticleImpl ;
       
       float p[3] ;
-      p[0] = reco4v.px() ;
-      p[1] = reco4v.py() ;
-      p[2] = reco4v.pz() ;
+      p[0] = px ;
+      p[1] = py ;
+      p[2] = pz ;
+
+      // as HepLorentzVector::m()
+      const double m2 = e * e - p2 ;
       
       rec->setMomentum( p ) ;
-      rec->setEnergy( reco4v.e() ) ;
-      rec->setMass( reco4v.m() ) ;
+      rec->setEnergy( e ) ;
+      rec->setMass( m2 < 0. ? -std::sqrt( -m2 ) : std::sqrt( m2 ) ) ;
 
       rec->setCharge( mcp->getCharge() ) ;
     
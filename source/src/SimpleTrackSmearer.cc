@@ -4,6 +4,8 @@
 
 #include "marlin/SimpleTrackSmearer.h"
 
+#include "marlin/ZigguratGaussian.h"
+
 #include "CLHEP/Random/RandGauss.h"
 #include "CLHEP/Random/RandEngine.h"
 
@@ -37,6 +39,12 @@ namespace marlin{
       
       _resVec.push_back( TrackResolution( dPP, thMin, thMax ) );
     }
+
+    std::vector< std::pair<double,double> > ranges ;
+    for( unsigned int i=0 ; i < _resVec.size() ; i++ )
+      ranges.push_back( std::make_pair( _resVec[i].ThMin, _resVec[i].ThMax ) ) ;
+
+    _bins.init( ranges ) ;
   }
   
   
@@ -48,15 +56,10 @@ namespace marlin{
 
     if( theta > M_PI_2 )  theta = M_PI - theta ; // need to transform to [0,pi/2] 
       
-    double resolution = -1. ; 
+    const int iRes = resolutionIndex( theta ) ;
 
-    for( unsigned int i=0 ; i <  _resVec.size() ; i++ ){
+    double resolution = ( iRes >= 0 ? _resVec[ iRes ].DPP : -1. ) ; 
 
-      if( theta <= _resVec[i].ThMax  &&  theta > _resVec[i].ThMin ) {
-	resolution =  _resVec[i].DPP ;
-	break ;
-      }
-    }
     HepLorentzVector sv( 0., 0. , 0., 0. ) ;
     
     if( resolution > - 1e-10  ) {
@@ -77,25 +80,85 @@ namespace marlin{
 // 		<< std::endl ;
 
 
-      // assume perfect electron and muon ID and
-      // assign pion mass to everything else
+      sv.setVectM(  n3v  , trackMass( pdgCode )  ) ;
 
-      double mass = PION_MASS ; 
+    } 
+      
+    return sv ;
 
-      if( std::abs( pdgCode ) == 12  )  // electron
+  }
 
-	mass = ELECTRON_MASS ;
 
-      else if( std::abs( pdgCode ) == 13  )  // muon
+  void SimpleTrackSmearer::smearFourVectors( FourVectorArrays& v ) {
 
-	mass = MUON_MASS ;
-      
-      sv.setVectM(  n3v  , mass  ) ;
+    const size_t n = v.size ;
 
-    } 
-      
-    return sv ;
+    // ---- resolutions first - random numbers are only drawn for the tracks with a resolution
+    std::vector<double> sigma( n, 0. ) ;
+    std::vector<char> smeared( n, 0 ) ;
+    size_t nSmeared = 0 ;
+
+    for( size_t i=0 ; i < n ; ++i ) {
+
+      const double pT = std::sqrt( v.px[i] * v.px[i] + v.py[i] * v.py[i] ) ;
+      double theta = ( pT == 0. && v.pz[i] == 0. ? 0. : std::atan2( pT, v.pz[i] ) ) ;
+
+      if( theta > M_PI_2 )  theta = M_PI - theta ;
+
+      const int iRes = resolutionIndex( theta ) ;
+
+      if( iRes >= 0 && _resVec[ iRes ].DPP > - 1e-10 ) {
+
+	const double P = std::sqrt( v.px[i] * v.px[i] + v.py[i] * v.py[i] + v.pz[i] * v.pz[i] ) ;
+	sigma[i] = P * P * _resVec[ iRes ].DPP ;
+	smeared[i] = 1 ;
+	++nSmeared ;
+      }
+    }
+
+    std::vector<double> gauss( nSmeared ) ;
+
+    if( nSmeared > 0 && v.random != 0 )
+      ZigguratGaussian::shootArray( *v.random, nSmeared, &gauss[0] ) ;
+    else if( nSmeared > 0 )
+      RandGauss::shootArray( nSmeared, &gauss[0] ) ;
+
+    // ---- smearing
+    for( size_t i=0, k=0 ; i < n ; ++i ) {
+
+      if( ! smeared[i] ) {
+	v.px[i] = v.py[i] = v.pz[i] = v.e[i] = 0. ;
+	continue ;
+      }
+
+      const double P = std::sqrt( v.px[i] * v.px[i] + v.py[i] * v.py[i] + v.pz[i] * v.pz[i] ) ;
+      const double deltaP = gauss[ k++ ] * sigma[i] ;
+
+      if( P > 0. ) {
+	const double scale = ( P + deltaP ) / P ;
+	v.px[i] *= scale ;
+	v.py[i] *= scale ;
+	v.pz[i] *= scale ;
+      }
+
+      const double mass = trackMass( v.pdg[i] ) ;
+      v.e[i] = std::sqrt( mass * mass + ( v.px[i] * v.px[i] + v.py[i] * v.py[i] + v.pz[i] * v.pz[i] ) ) ;
+    }
+  }
+
+
+  double SimpleTrackSmearer::trackMass( int pdgCode ) {
+
+    // assume perfect electron and muon ID and
+    // assign pion mass to everything else
+
+    if( std::abs( pdgCode ) == 12  )  // electron
+      return ELECTRON_MASS ;
+
+    if( std::abs( pdgCode ) == 13  )  // muon
+      return MUON_MASS ;
 
+    return PION_MASS ;
   }
   
 }
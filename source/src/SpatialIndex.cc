@@ -0,0 +1,391 @@
+#include "marlin/SpatialIndex.h"
+#include "marlin/CompiledCellIDDecoder.h"
+#include "marlin/EventDataService.h"
+#include "marlin/Exceptions.h"
+#include "marlin/PipelineContext.h"
+
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCParameters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace marlin{
+
+  namespace {
+
+    // grids are coarsened if they would have more cells than this per hit
+    const unsigned maxCellsPerHit = 8 ;
+
+    // in double precision: neither the difference nor the cell number overflows
+    inline int cellOf( float x, float min, float cellSize, int n ) {
+      const double c = std::floor( ( double( x ) - min ) / cellSize ) ;
+      return ( ! ( c > 0. ) ? 0 : ( c >= n ? n - 1 : int( c ) ) ) ;
+    }
+  }
+
+
+  std::shared_ptr<const SpatialIndex> SpatialIndex::get( EVENT::LCEvent* evt, const std::string& colName,
+							 Type type, float cellSize ) {
+
+    std::stringstream key ;
+    key << "SpatialIndex:" << colName << ":" << type << ":" << cellSize ;
+
+    return PipelineContext::current()->eventData()->get<SpatialIndex>( evt, key.str(), [&](){
+
+	std::string encoding ;
+	if( type == LAYER_GRID )
+	  encoding = evt->getCollection( colName )->getParameters().getStringVal( lcio::LCIO::CELLIDENCODING ) ;
+
+	return new SpatialIndex( HitSoAView::get( evt, colName ), type, cellSize, encoding ) ;
+      } ) ;
+  }
+
+
+  void SpatialIndex::prepare( EVENT::LCEvent* evt, const std::vector<Request>& requests ) {
+
+    PipelineContext* ctx = PipelineContext::current() ;
+
+    std::vector<std::exception_ptr> errors( requests.size() ) ;
+    std::atomic<unsigned> next( 0 ) ;
+
+    auto work = [&]() {
+
+      PipelineContext::Scope ctxScope( ctx ) ;
+
+      for( unsigned i = next++ ; i < requests.size() ; i = next++ ) {
+	try{
+	  get( evt, requests[i].collection, requests[i].type, requests[i].cellSize ) ;
+	}
+	catch(...) {
+	  errors[i] = std::current_exception() ;
+	}
+      }
+    } ;
+
+    // the calling thread builds indices as well
+    unsigned nThreads = std::min< unsigned >( requests.size() , std::max( 1u , std::thread::hardware_concurrency() ) ) ;
+
+    std::vector<std::thread> threads ;
+    for( unsigned i=1 ; i < nThreads ; ++i )
+      threads.emplace_back( work ) ;
+
+    work() ;
+
+    for( unsigned i=0 ; i < threads.size() ; ++i )
+      threads[i].join() ;
+
+    for( unsigned i=0 ; i < errors.size() ; ++i ) {
+      if( errors[i] )
+	std::rethrow_exception( errors[i] ) ;
+    }
+  }
+
+
+  SpatialIndex::SpatialIndex( std::shared_ptr<const HitSoAView> hits, Type type, float cellSize,
+			      const std::string& encoding ) :
+    _hits( hits ), _type( type ), _cellSize( cellSize > 0.f ? cellSize : 1.f ) {
+
+    const unsigned n = _hits->size() ;
+
+    // the grids and the tree need an ordered extent of the hits
+    for( unsigned i=0 ; i < n ; ++i ) {
+
+      if( ! std::isfinite( _hits->x()[i] ) || ! std::isfinite( _hits->y()[i] ) || ! std::isfinite( _hits->z()[i] ) ) {
+
+	std::stringstream str ;
+	str << "SpatialIndex: hit " << i << " has a non-finite position" ;
+	throw Exception( str.str() ) ;
+      }
+    }
+
+    switch( _type ) {
+
+    case UNIFORM_GRID : {
+
+      std::vector<unsigned> all( n ) ;
+      for( unsigned i=0 ; i < n ; ++i )
+	all[i] = i ;
+
+      buildGrid( _grid, all, 3 ) ;
+      break ;
+    }
+    case KD_TREE : {
+
+      _tree.resize( n ) ;
+      for( unsigned i=0 ; i < n ; ++i )
+	_tree[i] = i ;
+
+      buildTree( 0, n, 0 ) ;
+      break ;
+    }
+    case LAYER_GRID : {
+
+      if( encoding.empty() )
+	throw Exception( "SpatialIndex: no CellIDEncoding for the layer grid" ) ;
+
+      std::shared_ptr<const CompiledCellIDDecoder> decoder = CompiledCellIDDecoder::get( encoding ) ;
+
+      std::vector<int> layers( n ) ;
+      decoder->decode( _hits->cellID(), n, decoder->index( "layer" ), layers.data() ) ;
+
+      std::map< int, std::vector<unsigned> > layerHits ;
+
+      for( unsigned i=0 ; i < n ; ++i )
+	layerHits[ layers[i] ].push_back( i ) ;
+
+      for( std::map< int, std::vector<unsigned> >::const_iterator it = layerHits.begin() ; it != layerHits.end() ; ++it )
+	buildGrid( _layers[ it->first ], it->second, 2 ) ;
+
+      break ;
+    }
+    default:
+      throw Exception( "SpatialIndex: unknown index type" ) ;
+    }
+  }
+
+
+  float SpatialIndex::distance2( size_t i, const float* p ) const {
+
+    const float dx = _hits->x()[i] - p[0] ;
+    const float dy = _hits->y()[i] - p[1] ;
+    const float dz = _hits->z()[i] - p[2] ;
+    return dx * dx + dy * dy + dz * dz ;
+  }
+
+
+  void SpatialIndex::buildGrid( Grid& grid, const std::vector<unsigned>& hits, int dims ) const {
+
+    const float* coord[3] = { _hits->x(), _hits->y(), _hits->z() } ;
+
+    float max[3] = { 0.f, 0.f, 0.f } ;
+
+    for( int d=0 ; d < dims ; ++d ) {
+
+      grid.min[d] = std::numeric_limits<float>::max() ;
+      max[d] = std::numeric_limits<float>::lowest() ;
+
+      for( unsigned i=0 ; i < hits.size() ; ++i ) {
+	grid.min[d] = std::min( grid.min[d], coord[d][ hits[i] ] ) ;
+	max[d] = std::max( max[d], coord[d][ hits[i] ] ) ;
+      }
+    }
+
+    if( hits.empty() )
+      grid.min[0] = grid.min[1] = grid.min[2] = max[0] = max[1] = max[2] = 0.f ;
+
+    // sparse events in a large volume get larger cells
+    const double maxCells = std::max< double >( 64, double( maxCellsPerHit ) * hits.size() ) ;
+
+    grid.cellSize = _cellSize ;
+
+    // terminates for finite positions: the extent in double precision is finite
+    while( true ) {
+
+      double nCells = 1. ;
+      for( int d=0 ; d < dims ; ++d )
+	nCells *= std::floor( ( double( max[d] ) - grid.min[d] ) / grid.cellSize ) + 1. ;
+
+      if( nCells <= maxCells ) {
+	for( int d=0 ; d < dims ; ++d )
+	  grid.n[d] = int( ( double( max[d] ) - grid.min[d] ) / grid.cellSize ) + 1 ;
+	break ;
+      }
+
+      grid.cellSize *= 2.f ;
+    }
+
+    const unsigned nCells = grid.n[0] * grid.n[1] * grid.n[2] ;
+
+    // counting sort of the hits by cell
+    std::vector<unsigned> cells( hits.size() ) ;
+    grid.cellStart.assign( nCells + 1, 0 ) ;
+
+    for( unsigned i=0 ; i < hits.size() ; ++i ) {
+
+      const unsigned h = hits[i] ;
+      unsigned c = 0 ;
+      for( int d = dims - 1 ; d >= 0 ; --d )
+	c = c * grid.n[d] + cellOf( coord[d][h], grid.min[d], grid.cellSize, grid.n[d] ) ;
+
+      cells[i] = c ;
+      ++grid.cellStart[ c + 1 ] ;
+    }
+
+    for( unsigned c=0 ; c < nCells ; ++c )
+      grid.cellStart[ c + 1 ] += grid.cellStart[ c ] ;
+
+    std::vector<unsigned> pos( grid.cellStart.begin(), grid.cellStart.end() - 1 ) ;
+    grid.order.resize( hits.size() ) ;
+
+    for( unsigned i=0 ; i < hits.size() ; ++i )
+      grid.order[ pos[ cells[i] ]++ ] = hits[i] ;
+  }
+
+
+  void SpatialIndex::searchGrid( const Grid& grid, float x, float y, float z, float radius,
+				 std::vector<size_t>& result ) const {
+
+    if( grid.order.empty() )
+      return ;
+
+    const float p[3] = { x, y, z } ;
+    const float r2 = radius * radius ;
+
+    int lo[3], hi[3] ;
+    for( int d=0 ; d < 3 ; ++d ) {
+      lo[d] = cellOf( p[d] - radius, grid.min[d], grid.cellSize, grid.n[d] ) ;
+      hi[d] = cellOf( p[d] + radius, grid.min[d], grid.cellSize, grid.n[d] ) ;
+    }
+
+    for( int iz = lo[2] ; iz <= hi[2] ; ++iz ) {
+      for( int iy = lo[1] ; iy <= hi[1] ; ++iy ) {
+	for( int ix = lo[0] ; ix <= hi[0] ; ++ix ) {
+
+	  const unsigned c = ( iz * grid.n[1] + iy ) * grid.n[0] + ix ;
+
+	  for( unsigned k = grid.cellStart[c] ; k < grid.cellStart[ c + 1 ] ; ++k ) {
+	    if( distance2( grid.order[k], p ) <= r2 )
+	      result.push_back( grid.order[k] ) ;
+	  }
+	}
+      }
+    }
+  }
+
+
+  void SpatialIndex::buildTree( unsigned first, unsigned last, int depth ) {
+
+    if( last - first <= 1 )
+      return ;
+
+    const float* coord = ( depth % 3 == 0 ? _hits->x() : ( depth % 3 == 1 ? _hits->y() : _hits->z() ) ) ;
+    const unsigned mid = ( first + last ) / 2 ;
+
+    std::nth_element( _tree.begin() + first, _tree.begin() + mid, _tree.begin() + last,
+		      [coord]( unsigned a, unsigned b ){ return coord[a] < coord[b] ; } ) ;
+
+    buildTree( first, mid, depth + 1 ) ;
+    buildTree( mid + 1, last, depth + 1 ) ;
+  }
+
+
+  void SpatialIndex::searchTree( unsigned first, unsigned last, int depth, const float* p, float r2,
+				 std::vector<size_t>& result ) const {
+
+    if( first >= last )
+      return ;
+
+    const unsigned mid = ( first + last ) / 2 ;
+    const unsigned h = _tree[ mid ] ;
+
+    if( distance2( h, p ) <= r2 )
+      result.push_back( h ) ;
+
+    const float* coord = ( depth % 3 == 0 ? _hits->x() : ( depth % 3 == 1 ? _hits->y() : _hits->z() ) ) ;
+    const float d = p[ depth % 3 ] - coord[h] ;
+
+    if( d <= 0.f || d * d <= r2 )
+      searchTree( first, mid, depth + 1, p, r2, result ) ;
+
+    if( d >= 0.f || d * d <= r2 )
+      searchTree( mid + 1, last, depth + 1, p, r2, result ) ;
+  }
+
+
+  void SpatialIndex::nearestInTree( unsigned first, unsigned last, int depth, const float* p,
+				    size_t& best, float& best2 ) const {
+
+    if( first >= last )
+      return ;
+
+    const unsigned mid = ( first + last ) / 2 ;
+    const unsigned h = _tree[ mid ] ;
+
+    const float dist2 = distance2( h, p ) ;
+    if( dist2 < best2 ) {
+      best2 = dist2 ;
+      best = h ;
+    }
+
+    const float* coord = ( depth % 3 == 0 ? _hits->x() : ( depth % 3 == 1 ? _hits->y() : _hits->z() ) ) ;
+    const float d = p[ depth % 3 ] - coord[h] ;
+
+    // the side of p first
+    if( d <= 0.f ) {
+      nearestInTree( first, mid, depth + 1, p, best, best2 ) ;
+      if( d * d < best2 )
+	nearestInTree( mid + 1, last, depth + 1, p, best, best2 ) ;
+    }
+    else {
+      nearestInTree( mid + 1, last, depth + 1, p, best, best2 ) ;
+      if( d * d < best2 )
+	nearestInTree( first, mid, depth + 1, p, best, best2 ) ;
+    }
+  }
+
+
+  void SpatialIndex::findNeighbours( float x, float y, float z, float radius, std::vector<size_t>& result ) const {
+
+    switch( _type ) {
+
+    case UNIFORM_GRID :
+      searchGrid( _grid, x, y, z, radius, result ) ;
+      break ;
+
+    case KD_TREE : {
+      const float p[3] = { x, y, z } ;
+      searchTree( 0, _tree.size(), 0, p, radius * radius, result ) ;
+      break ;
+    }
+    case LAYER_GRID :
+      for( std::map<int, Grid>::const_iterator it = _layers.begin() ; it != _layers.end() ; ++it )
+	searchGrid( it->second, x, y, z, radius, result ) ;
+      break ;
+    }
+  }
+
+
+  void SpatialIndex::findNeighboursInLayer( int layer, float x, float y, float z, float radius,
+					    std::vector<size_t>& result ) const {
+
+    if( _type != LAYER_GRID )
+      throw Exception( "SpatialIndex::findNeighboursInLayer: not a layer grid" ) ;
+
+    std::map<int, Grid>::const_iterator it = _layers.find( layer ) ;
+
+    if( it != _layers.end() )
+      searchGrid( it->second, x, y, z, radius, result ) ;
+  }
+
+
+  size_t SpatialIndex::nearest( float x, float y, float z ) const {
+
+    const float p[3] = { x, y, z } ;
+
+    size_t best = _hits->size() ;
+    float best2 = std::numeric_limits<float>::max() ;
+
+    if( _type == KD_TREE ) {
+      nearestInTree( 0, _tree.size(), 0, p, best, best2 ) ;
+      return best ;
+    }
+
+    // linear scan over the arrays of the grids
+    for( size_t i=0 ; i < _hits->size() ; ++i ) {
+      const float dist2 = distance2( i, p ) ;
+      if( dist2 < best2 ) {
+	best2 = dist2 ;
+	best = i ;
+      }
+    }
+    return best ;
+  }
+
+}
@@ -0,0 +1,168 @@
+#include "marlin/StartupProfiler.h"
+
+#include "streamlog/streamlog.h"
+
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+namespace marlin{
+
+  namespace {
+    double secondsSince( std::chrono::steady_clock::time_point t0 ) {
+      return std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count() ;
+    }
+  }
+
+
+  StartupProfiler::Phase::Phase( const std::string& category, const std::string& name ) :
+    _category( category ), _name( name ), _start( std::chrono::steady_clock::now() ),
+    _rss( 0 ), _previous( nullptr ), _stopped( false ) {
+
+    StartupProfiler* prof = StartupProfiler::instance() ;
+
+    if( ! prof->_active ) {
+      _stopped = true ;
+      return ;
+    }
+    _rss = residentKB() ;
+    _previous = prof->_current ;
+    prof->_current = this ;
+  }
+
+
+  void StartupProfiler::Phase::stop() {
+
+    if( _stopped )
+      return ;
+    _stopped = true ;
+
+    StartupProfiler* prof = StartupProfiler::instance() ;
+
+    Record r ;
+    r.category = _category ;
+    r.name = _name ;
+    r.seconds = secondsSince( _start ) ;
+    r.staticInitSeconds = ( _registered ? secondsSince( _firstRegistration ) : -1. ) ;
+    r.rssKB = residentKB() - _rss ;
+
+    prof->_records.push_back( r ) ;
+    prof->_current = _previous ;
+  }
+
+
+  StartupProfiler* StartupProfiler::instance() {
+
+    static StartupProfiler prof ;
+    return &prof ;
+  }
+
+
+  StartupProfiler::StartupProfiler() : _start( std::chrono::steady_clock::now() ), _startRSS( residentKB() ) {
+  }
+
+
+  void StartupProfiler::processorRegistered() {
+
+    if( _current != nullptr && ! _current->_registered ) {
+      _current->_registered = true ;
+      _current->_firstRegistration = std::chrono::steady_clock::now() ;
+    }
+  }
+
+
+  void StartupProfiler::finish() {
+
+    if( ! _active )
+      return ;
+
+    _active = false ;
+    _total = secondsSince( _start ) ;
+    _totalRSS = residentKB() - _startRSS ;
+  }
+
+
+  void StartupProfiler::restart() {
+
+    _records.clear() ;
+    _current = nullptr ;
+    _active = true ;
+    _start = std::chrono::steady_clock::now() ;
+    _startRSS = residentKB() ;
+  }
+
+
+  long StartupProfiler::residentKB() {
+
+    long pages = 0 , resident = 0 ;
+    std::ifstream statm( "/proc/self/statm" ) ;
+
+    if( ! ( statm >> pages >> resident ) )
+      return 0 ;
+
+    return resident * ( sysconf( _SC_PAGESIZE ) / 1024 ) ;
+  }
+
+
+  void StartupProfiler::print() const {
+
+    streamlog_out( MESSAGE ) << " --------------------------------------------------------- " << std::endl
+			     << "      Startup profile :      " << std::endl
+			     << std::endl ;
+
+    for( unsigned i=0 ; i < _records.size() ; ++i ) {
+
+      const Record& r = _records[i] ;
+
+      streamlog_out( MESSAGE ) << "  " << std::setw(10) << std::left << r.category << " "
+			       << std::setw(40) << std::left << r.name.substr( 0, 40 ) << std::right
+			       << std::setw(12) << std::scientific << r.seconds << " s "
+			       << std::setw(10) << r.rssKB << " kB RSS" ;
+
+      if( r.staticInitSeconds >= 0. )
+	streamlog_out( MESSAGE ) << "  ( static init: " << std::scientific << r.staticInitSeconds << " s )" ;
+
+      streamlog_out( MESSAGE ) << std::endl ;
+    }
+
+    streamlog_out( MESSAGE ) << "  " << std::setw(51) << std::left << "Total startup time:" << std::right
+			     << std::setw(12) << std::scientific << _total << " s "
+			     << std::setw(10) << _totalRSS << " kB RSS" << std::endl
+			     << " --------------------------------------------------------- " << std::endl ;
+  }
+
+
+  void StartupProfiler::writeJSON( const std::string& fileName ) const {
+
+    std::ofstream out( fileName.c_str() ) ;
+
+    if( ! out ) {
+      streamlog_out( ERROR ) << " StartupProfiler: can't write file " << fileName << std::endl ;
+      return ;
+    }
+
+    out << "{\n  \"totalSeconds\": " << _total << ",\n  \"totalRssKB\": " << _totalRSS << ",\n  \"phases\": [" ;
+
+    for( unsigned i=0 ; i < _records.size() ; ++i ) {
+
+      const Record& r = _records[i] ;
+
+      std::string name ;  // escape for JSON
+      for( unsigned j=0 ; j < r.name.size() ; ++j ) {
+	if( r.name[j] == '"' || r.name[j] == '\\' )
+	  name += '\\' ;
+	name += r.name[j] ;
+      }
+
+      out << ( i ? "," : "" ) << "\n    { \"category\": \"" << r.category << "\", \"name\": \"" << name
+	  << "\", \"seconds\": " << r.seconds << ", \"rssKB\": " << r.rssKB ;
+
+      if( r.staticInitSeconds >= 0. )
+	out << ", \"staticInitSeconds\": " << r.staticInitSeconds ;
+
+      out << " }" ;
+    }
+    out << "\n  ]\n}\n" ;
+  }
+
+}
@@ -76,6 +76,13 @@ namespace marlin{
     //     if( _nEvt == 80   )
     //      throw StopProcessingException( this ) ;
 
+    //  --- or equivalently without exceptions: ---------
+
+    //    if( !(  _nEvt % 7 )  ) {
+    //      skipEvent() ;
+    //      return ;
+    //    }
+
     // --- loop 3 times over the first 3 events and do a 'calibration' ) ------
 
     if( isFirstEvent() ){
@@ -1,6 +1,7 @@
 
 #include "marlin/XMLParser.h"
 #include "marlin/Exceptions.h"
+#include "marlin/StartupProfiler.h"
 #include "marlin/tinyxml.h"
 
 #include <algorithm>
@@ -23,6 +24,7 @@ namespace marlin{
 
     void XMLParser::parse(){
 
+        StartupProfiler::Phase readPhase( "parser", "read " + _fileName ) ;
 
         _doc = std::unique_ptr<TiXmlDocument>( new TiXmlDocument );
         bool loadOkay = _doc->LoadFile(_fileName  ) ;
@@ -47,6 +49,10 @@ namespace marlin{
                     + _fileName  ) ;
         }
         
+        readPhase.stop() ;
+
+        StartupProfiler::Phase constantsPhase( "parser", "constants and includes" ) ;
+
         TiXmlNode* section = 0 ;
         
         section = root->FirstChild("constants") ;
@@ -60,6 +66,10 @@ namespace marlin{
 
         processIncludeElements( root , constants ) ;
 
+        constantsPhase.stop() ;
+
+        StartupProfiler::Phase sectionsPhase( "parser", "global, execute and processor sections" ) ;
+
         _map[ "Global" ] = std::make_shared<StringParameters>();
         StringParameters*  globalParameters = _map[ "Global" ].get();
 
@@ -641,6 +651,8 @@ namespace marlin{
             refFileName = ref ;
         }
 
+        _includedFiles.push_back( refFileName ) ;
+
         bool loadOkay = document.LoadFile( refFileName ) ;
 
         if( !loadOkay ) {
@@ -0,0 +1,96 @@
+#include "marlin/ZigguratGaussian.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace marlin{
+
+  namespace {
+
+    const unsigned nLayers = 128 ;
+    const double zigR = 3.442619855899 ;         // start of the tail
+    const double zigV = 9.91256303526217e-3 ;    // area of every layer
+
+    /** Layer boundaries x[i] and ratios x[i+1]/x[i] */
+    struct Tables {
+
+      double x[ nLayers + 1 ] ;
+      double r[ nLayers ] ;
+
+      Tables() {
+
+	double f = std::exp( -0.5 * zigR * zigR ) ;
+
+	x[0] = zigV / f ;   // base layer including the tail
+	x[1] = zigR ;
+	x[ nLayers ] = 0. ;
+
+	for( unsigned i=2 ; i < nLayers ; ++i ) {
+	  x[i] = std::sqrt( -2. * std::log( zigV / x[ i - 1 ] + f ) ) ;
+	  f = std::exp( -0.5 * x[i] * x[i] ) ;
+	}
+	for( unsigned i=0 ; i < nLayers ; ++i )
+	  r[i] = x[ i + 1 ] / x[i] ;
+      }
+    } ;
+
+    const Tables& tables() {
+      static const Tables t ;
+      return t ;
+    }
+
+    inline uint64_t draw64( RandomStream& stream ) {
+      const uint64_t hi = stream() ;
+      return ( hi << 32 ) | stream() ;
+    }
+
+    // sample from the tail x > zigR (Marsaglia 1964)
+    double tail( RandomStream& stream, bool negative ) {
+
+      double x, y ;
+      do {
+	x = std::log( stream.uniform() ) / zigR ;
+	y = std::log( stream.uniform() ) ;
+      } while( -2. * y < x * x ) ;
+
+      return ( negative ? x - zigR : zigR - x ) ;
+    }
+  }
+
+
+  double ZigguratGaussian::shoot( RandomStream& stream ) {
+
+    const Tables& t = tables() ;
+
+    for(;;) {
+
+      const uint64_t w = draw64( stream ) ;
+
+      const unsigned i = w & ( nLayers - 1 ) ;                        // low 7 bits: layer
+      const double u = ( w >> 11 ) * ( 1.0 / 4503599627370496.0 ) - 1. ; // high 53 bits: [-1,1)
+
+      // inside the rectangle of the layer
+      if( std::fabs( u ) < t.r[i] )
+	return u * t.x[i] ;
+
+      if( i == 0 )
+	return tail( stream, u < 0. ) ;
+
+      // in the wedge - accept with the density
+      const double x = u * t.x[i] ;
+      const double f0 = std::exp( -0.5 * ( t.x[i] * t.x[i] - x * x ) ) ;
+      const double f1 = std::exp( -0.5 * ( t.x[ i + 1 ] * t.x[ i + 1 ] - x * x ) ) ;
+
+      if( f1 + stream.uniform() * ( f0 - f1 ) < 1. )
+	return x ;
+    }
+  }
+
+
+  void ZigguratGaussian::shootArray( RandomStream& stream, size_t n, double* out, double mean, double sigma ) {
+
+    for( size_t k=0 ; k < n ; ++k )
+      out[k] = mean + sigma * shoot( stream ) ;
+  }
+
+}
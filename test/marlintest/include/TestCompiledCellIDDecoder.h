@@ -0,0 +1,49 @@
+#ifndef TestCompiledCellIDDecoder_h
+#define TestCompiledCellIDDecoder_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the CompiledCellIDDecoder: decodes random cellIDs for several encodings
+ *   with signed and unsigned fields and compares the values with UTIL::BitField64.
+ */
+
+class TestCompiledCellIDDecoder : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestCompiledCellIDDecoder ; }
+
+
+  TestCompiledCellIDDecoder() ;
+
+
+  /** Compares the decoders with UTIL::BitField64.
+   */
+  virtual void init() ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Compares the decoder of the encoding with UTIL::BitField64 for n random cellIDs */
+  void checkEncoding( const std::string& encoding, unsigned n ) ;
+
+  int _nCellIDs=0;
+  int _nEncodings=0;
+  int _nErrors=0;
+} ;
+
+#endif
+
+
+
@@ -0,0 +1,68 @@
+#ifndef TestFastMCThreads_h
+#define TestFastMCThreads_h 1
+
+#include "marlin/MarlinConfig.h"
+
+#ifdef MARLIN_CLHEP  // only if CLHEP is available !
+
+#include "marlin/Processor.h"
+#include "marlin/SimpleParticleFactory.h"
+
+#include "lcio.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the chunked batch mode of the SimpleFastMCProcessor: creates the
+ *   ReconstructedParticles of the stable MCParticles with one and with four threads for several
+ *   chunk sizes and requires bit-identical results - for a single chunk also identical to one
+ *   call of SimpleParticleFactory::createReconstructedParticles().
+ */
+
+class TestFastMCThreads : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestFastMCThreads ; }
+
+
+  TestFastMCThreads() ;
+
+
+  /** Creates the particle factory with the default resolutions of the SimpleFastMCProcessor.
+   */
+  virtual void init() ;
+
+  /** Compares the particles created with one and with four threads.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Compares the particles - deletes both. */
+  void compare( std::vector<ReconstructedParticle*>& recs, std::vector<ReconstructedParticle*>& expected,
+		const std::string& what ) ;
+
+  /** Input collection name.
+   */
+  std::string _colName="";
+
+  std::unique_ptr<SimpleParticleFactory> _factory{};
+  std::vector< std::unique_ptr<IFourVectorSmearer> > _smearers{};
+
+  int _nEvt=0;
+  int _nParticles=0;
+  int _nErrors=0;
+} ;
+
+#endif // MARLIN_CLHEP
+#endif
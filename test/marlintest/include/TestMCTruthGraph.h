@@ -0,0 +1,58 @@
+#ifndef TestMCTruthGraph_h
+#define TestMCTruthGraph_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the MCTruthGraph: compares the topological order, the ancestors and the
+ *   stable descendants with walks along the parent and daughter links of the MCParticles - for
+ *   the events read and for generated graphs with and without the ancestor bitsets.
+ */
+
+class TestMCTruthGraph : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestMCTruthGraph ; }
+
+
+  TestMCTruthGraph() ;
+
+
+  /** Checks the generated graphs.
+   */
+  virtual void init() ;
+
+  /** Checks the graph of the MCParticle collection.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Checks the graph of the collection - the ancestors of every step-th particle */
+  void checkGraph( const LCCollection* col, unsigned step, bool ancestorBits ) ;
+
+  /** Input collection name.
+   */
+  std::string _colName="";
+
+  int _nEvt=0;
+  int _nGenerated=0;
+  int _nErrors=0;
+} ;
+
+#endif
+
+
+
@@ -0,0 +1,44 @@
+#ifndef TestParallelInit_h
+#define TestParallelInit_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the concurrent init() and end() of independent processors (global
+ *   parameter ParallelInit): writes streamlog output of several levels and std::cout output
+ *   in init(), which has to be printed with the name and Verbosity of the processor and in
+ *   the order of the processors.
+ */
+
+class TestParallelInit : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestParallelInit ; }
+
+
+  TestParallelInit() ;
+
+
+  /** Waits (at most one second) until init() of the other instances runs as well, then
+   *  writes the output.
+   */
+  virtual void init() ;
+
+  /** Prints whether init() ran concurrently.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  bool _concurrent=false;
+} ;
+
+#endif
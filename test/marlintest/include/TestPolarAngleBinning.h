@@ -0,0 +1,53 @@
+#ifndef TestPolarAngleBinning_h
+#define TestPolarAngleBinning_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the PolarAngleBinning: compares index() with a linear search for the
+ *   first range containing theta - for overlapping, gapped and empty ranges.
+ */
+
+class TestPolarAngleBinning : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestPolarAngleBinning ; }
+
+
+  TestPolarAngleBinning() ;
+
+
+  /** Compares the binning with the linear search.
+   */
+  virtual void init() ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Compares the binning of the ranges with the linear search at the edges, next to the
+   *  edges and for n random angles.
+   */
+  void checkRanges( const std::vector< std::pair<double,double> >& ranges, unsigned n ) ;
+
+  int _nAngles=0;
+  int _nBinnings=0;
+  int _nErrors=0;
+} ;
+
+#endif
+
+
+
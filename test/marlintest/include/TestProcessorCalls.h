@@ -0,0 +1,71 @@
+#ifndef TestProcessorCalls_h
+#define TestProcessorCalls_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the calls of the ProcessorMgr: counts the events it is called for and
+ *   compares them in end() with the expected number. Can skip the remaining processors for an
+ *   event with Processor::skipEvent() or stop the processing with Processor::requestStop().
+ *   Checks that init() and processRunHeader() are called before the first event - also for
+ *   conditional processors initialized for their first event (LazyInit).
+ *
+ * @param ExpectedEvents          Number of events the processor has to be called for - -1 for any
+ * @param SkipEvent               Index of the call in which skipEvent() is called - -1 for none
+ * @param StopEvent               Index of the call in which requestStop() is called - -1 for none
+ * @param ReturnTrueFromEvent     Index of the first call that sets the return value to true
+ * @param ExpectedCallsBeforeInit Number of events all TestProcessorCalls are called for before init() - -1 for any
+ * @param RegisterSeeder          Register with the ProcessorEventSeeder and compare the seeds in processEvent()
+ * @param InputCollection         Name of an input collection the processor needs (SkipWithoutInputs) - not read
+ */
+
+class TestProcessorCalls : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestProcessorCalls ; }
+
+
+  TestProcessorCalls() ;
+
+
+  /** Counts the call - registers with the ProcessorEventSeeder if configured.
+   */
+  virtual void init() ;
+
+  /** Counts the run - checks that init() was called.
+   */
+  virtual void processRunHeader( LCRunHeader* run ) ;
+
+  /** Counts the event and sets the return value - skips it or requests the stop if configured.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+  /** Compares the number of calls with the expected ones and prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  int _expectedEvents=-1;
+  int _skipEvent=-1;
+  int _stopEvent=-1;
+  int _returnTrueFromEvent=0;
+  int _expectedCallsBeforeInit=-1;
+  bool _registerSeeder=false;
+  std::string _colName="";
+
+  int _nInit=0;
+  int _nRun=0;
+  int _nEvt=0;
+  int _nErrors=0;
+} ;
+
+#endif
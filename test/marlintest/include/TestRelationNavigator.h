@@ -0,0 +1,59 @@
+#ifndef TestRelationNavigator_h
+#define TestRelationNavigator_h 1
+
+#include "marlin/Processor.h"
+#include "marlin/RelationNavigator.h"
+
+#include "lcio.h"
+#include <string>
+
+namespace UTIL{
+  class LCRelationNavigator ;
+}
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the RelationNavigator: compares the related objects and weights in both
+ *   directions with UTIL::LCRelationNavigator for all LCRelation collections of the event and
+ *   for a collection of relations between the MCParticles with duplicated pairs.
+ *
+ * @param MCParticleCollection Name of the MCParticle collection
+ */
+
+class TestRelationNavigator : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestRelationNavigator ; }
+
+
+  TestRelationNavigator() ;
+
+
+  /** Compares the navigators of the relation collections.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Compares the navigator with UTIL::LCRelationNavigator for the sources of all relations of the collection */
+  void compare( const RelationNavigator& nav, const UTIL::LCRelationNavigator& expected,
+		const LCCollection* col, const std::string& colName ) ;
+
+  /** Input collection name.
+   */
+  std::string _colName="";
+
+  int _nEvt=0;
+  int _nCollections=0;
+  int _nErrors=0;
+} ;
+
+#endif
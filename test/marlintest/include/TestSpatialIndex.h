@@ -0,0 +1,60 @@
+#ifndef TestSpatialIndex_h
+#define TestSpatialIndex_h 1
+
+#include "marlin/Processor.h"
+#include "marlin/SpatialIndex.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the SpatialIndex: copies the positions of a SimCalorimeterHit collection
+ *   to a CalorimeterHit collection with five layers and compares findNeighbours(),
+ *   findNeighboursInLayer() and nearest() of the uniform grid, the kd-tree and the layer grid
+ *   with a brute-force scan over the hits. Also checks that hits with a non-finite position
+ *   are rejected.
+ *
+ * @param CollectionName Name of the SimCalorimeterHit collection
+ */
+
+class TestSpatialIndex : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestSpatialIndex ; }
+
+
+  TestSpatialIndex() ;
+
+
+  /** Checks that hits with a non-finite position are rejected.
+   */
+  virtual void init() ;
+
+  /** Compares the indices with the brute-force scan.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Compares the queries of the index around p with the brute-force scan */
+  void compare( const SpatialIndex& index, const float* p, float radius ) ;
+
+  /** Input collection name.
+   */
+  std::string _colName="";
+
+  int _nEvt=0;
+  int _nQueries=0;
+  int _nErrors=0;
+} ;
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TestZigguratGaussian_h
+#define TestZigguratGaussian_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor for the ZigguratGaussian: checks the moments, the tails and the shape of
+ *   the distribution of the numbers drawn from a fixed RandomStream.
+ */
+
+class TestZigguratGaussian : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestZigguratGaussian ; }
+
+
+  TestZigguratGaussian() ;
+
+
+  /** Draws the numbers and checks their distribution.
+   */
+  virtual void init() ;
+
+  /** Prints the number of errors.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Number of random numbers drawn.
+   */
+  int _nNumbers=0;
+
+  int _nErrors=0;
+} ;
+
+#endif
+
+
+
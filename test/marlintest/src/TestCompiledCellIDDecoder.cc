@@ -0,0 +1,117 @@
+#include "TestCompiledCellIDDecoder.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/CompiledCellIDDecoder.h"
+
+#include "UTIL/BitField64.h"
+
+#include <random>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestCompiledCellIDDecoder aTestCompiledCellIDDecoder ;
+
+
+TestCompiledCellIDDecoder::TestCompiledCellIDDecoder() : Processor("TestCompiledCellIDDecoder") {
+
+  _description = "TestCompiledCellIDDecoder compares the CompiledCellIDDecoder with UTIL::BitField64" ;
+}
+
+
+void TestCompiledCellIDDecoder::init() {
+
+  // signed and unsigned fields, fields in both 32 bit words, explicit offsets and all 64 bits used
+  checkEncoding( "M:3,S-1:3,I:9,J:9,K-1:6" , 10000 ) ;
+  checkEncoding( "system:5,side:-2,layer:9,module:8,sensor:8" , 10000 ) ;
+  checkEncoding( "system:8,barrel:3,module:4,layer:8,slice:5,x:32:-16,y:-16" , 10000 ) ;
+  checkEncoding( "a:-1,b:1,c:-30,d:32" , 10000 ) ;
+
+  bool thrown = false ;
+  try{
+    CompiledCellIDDecoder decoder( "a:40,b:40" ) ;
+  }
+  catch( lcio::Exception& ) {
+    thrown = true ;
+  }
+  if( ! thrown ) {
+    streamlog_out(ERROR) << " no exception for the invalid encoding a:40,b:40" << std::endl ;
+    ++_nErrors ;
+  }
+}
+
+
+void TestCompiledCellIDDecoder::checkEncoding( const std::string& encoding, unsigned n ) {
+
+  std::shared_ptr<const CompiledCellIDDecoder> decoder = CompiledCellIDDecoder::get( encoding ) ;
+
+  UTIL::BitField64 bf( encoding ) ;
+
+  if( decoder->size() != bf.size() ) {
+    streamlog_out(ERROR) << " encoding " << encoding << " has " << decoder->size() << " fields instead of " << bf.size() << std::endl ;
+    ++_nErrors ;
+    return ;
+  }
+
+  // all bits clear and set, the highest bit of every field set and random values
+  std::vector<uint64_t> cellIDs ;
+  cellIDs.push_back( 0 ) ;
+  cellIDs.push_back( ~uint64_t( 0 ) ) ;
+
+  for( size_t i=0 ; i < decoder->size() ; ++i ) {
+    const uint64_t mask = (*decoder)[i].mask ;
+    cellIDs.push_back( mask & ~( mask >> 1 ) ) ;
+  }
+
+  std::mt19937_64 engine( 42 ) ;
+  while( cellIDs.size() < n )
+    cellIDs.push_back( engine() ) ;
+
+  std::vector< std::vector<int> > values ;
+  decoder->decode( cellIDs.data(), cellIDs.size(), values ) ;
+
+  for( size_t i=0 ; i < decoder->size() ; ++i ) {
+
+    const std::string& name = (*decoder)[i].name ;
+
+    if( decoder->index( name ) != bf.index( name ) ) {
+      streamlog_out(ERROR) << " encoding " << encoding << " field " << name << " has index " << decoder->index( name ) << std::endl ;
+      ++_nErrors ;
+    }
+
+    std::vector<int> field( cellIDs.size() ) ;
+    decoder->decode( cellIDs.data(), cellIDs.size(), i, field.data() ) ;
+
+    for( size_t k=0 ; k < cellIDs.size() ; ++k ) {
+
+      bf.setValue( cellIDs[k] ) ;
+
+      const long64 expected = bf[ name ].value() ;
+
+      if( decoder->value( cellIDs[k], i ) != expected || decoder->value( cellIDs[k], name ) != expected
+	  || field[k] != int( expected ) || values[i][k] != int( expected ) ) {
+
+	streamlog_out(ERROR) << " encoding " << encoding << " field " << name << " cellID " << std::hex << cellIDs[k] << std::dec
+			     << " : " << decoder->value( cellIDs[k], i ) << " " << field[k] << " " << values[i][k]
+			     << " instead of " << expected << std::endl ;
+	++_nErrors ;
+      }
+    }
+  }
+
+  _nCellIDs += cellIDs.size() ;
+  ++_nEncodings ;
+}
+
+
+void TestCompiledCellIDDecoder::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " decoded " << _nCellIDs << " cellIDs of " << _nEncodings << " encodings - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
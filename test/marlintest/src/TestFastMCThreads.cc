@@ -0,0 +1,152 @@
+#include "TestFastMCThreads.h"
+
+#ifdef MARLIN_CLHEP  // only if CLHEP is available !
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/SimpleFastMCProcessor.h"
+#include "marlin/SimpleTrackSmearer.h"
+#include "marlin/SimpleClusterSmearer.h"
+#include "marlin/FastMCParticleType.h"
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/MCParticle.h"
+#include "EVENT/ReconstructedParticle.h"
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestFastMCThreads aTestFastMCThreads ;
+
+
+TestFastMCThreads::TestFastMCThreads() : Processor("TestFastMCThreads") {
+
+  _description = "TestFastMCThreads compares the particles of the SimpleFastMCProcessor batch mode created with one and with four threads" ;
+
+  registerInputCollection( LCIO::MCPARTICLE,
+			   "MCParticleCollection" ,
+			   "Name of the MCParticle collection"  ,
+			   _colName ,
+			   std::string("MCParticle") ) ;
+}
+
+
+void TestFastMCThreads::init() {
+
+  // the default resolutions of the SimpleFastMCProcessor
+  _smearers.emplace_back( new SimpleTrackSmearer( { 5e-5, 0., 3.141593/2. } ) ) ;
+  _smearers.emplace_back( new SimpleClusterSmearer( { 0.01, 0.10, 0., 3.141593/2. } ) ) ;
+  _smearers.emplace_back( new SimpleClusterSmearer( { 0.04, 0.50, 0., 3.141593/2. } ) ) ;
+
+  _factory.reset( new SimpleParticleFactory ) ;
+  _factory->registerIFourVectorSmearer( _smearers[0].get(), CHARGED ) ;
+  _factory->registerIFourVectorSmearer( _smearers[1].get(), PHOTON ) ;
+  _factory->registerIFourVectorSmearer( _smearers[2].get(), NEUTRAL_HADRON ) ;
+  _factory->setMomentumCut( 0.001 ) ;
+
+  if( ! _factory->supportsConcurrentSmearing() ) {
+    streamlog_out(ERROR) << " the SimpleParticleFactory does not support concurrent smearing" << std::endl ;
+    ++_nErrors ;
+  }
+}
+
+
+void TestFastMCThreads::processEvent( LCEvent * evt ) {
+
+  const LCCollection* col = evt->getCollection( _colName ) ;
+
+  std::vector<const MCParticle*> mcps ;
+
+  for( int i=0 ; i < col->getNumberOfElements() ; ++i ) {
+
+    const MCParticle* mcp = static_cast<MCParticle*>( col->getElementAt( i ) ) ;
+
+    if( mcp->getGeneratorStatus() == 1 )
+      mcps.push_back( mcp ) ;
+  }
+
+  const RandomStream stream( {{ 1234567890u, 42u }} , {{ unsigned( _nEvt ), 0u, 0u, 0u }} ) ;
+
+  // ---- a single chunk draws from the stream itself - as one call of the factory
+  std::vector<ReconstructedParticle*> expected( mcps.size(), 0 ) ;
+  std::vector<ReconstructedParticle*> recs( mcps.size(), 0 ) ;
+
+  RandomStream random = stream ;
+  _factory->createReconstructedParticles( mcps.data(), mcps.size(), expected.data(), &random ) ;
+
+  SimpleFastMCProcessor::createInChunks( _factory.get(), stream, 0, 4, mcps, recs ) ;
+
+  compare( recs, expected, "one chunk" ) ;
+
+  // ---- the chunks do not depend on the number of threads
+  const size_t chunkSizes[4] = { 1, 7, 100, 1000 } ;
+
+  for( unsigned k=0 ; k < 4 ; ++k ) {
+
+    expected.assign( mcps.size(), 0 ) ;
+    recs.assign( mcps.size(), 0 ) ;
+
+    SimpleFastMCProcessor::createInChunks( _factory.get(), stream, chunkSizes[k], 1, mcps, expected ) ;
+    SimpleFastMCProcessor::createInChunks( _factory.get(), stream, chunkSizes[k], 4, mcps, recs ) ;
+
+    compare( recs, expected, "chunk size " + std::to_string( chunkSizes[k] ) ) ;
+  }
+
+  ++_nEvt ;
+}
+
+
+void TestFastMCThreads::compare( std::vector<ReconstructedParticle*>& recs, std::vector<ReconstructedParticle*>& expected,
+				 const std::string& what ) {
+
+  unsigned nCreated = 0 ;
+
+  for( size_t i=0 ; i < recs.size() ; ++i ) {
+
+    const ReconstructedParticle* r = recs[i] ;
+    const ReconstructedParticle* e = expected[i] ;
+
+    bool same = ( ( r == 0 ) == ( e == 0 ) ) ;
+
+    if( same && r != 0 ) {
+
+      // bit-identical: no tolerance
+      same = ( r->getMomentum()[0] == e->getMomentum()[0] && r->getMomentum()[1] == e->getMomentum()[1]
+	       && r->getMomentum()[2] == e->getMomentum()[2] && r->getEnergy() == e->getEnergy()
+	       && r->getMass() == e->getMass() && r->getCharge() == e->getCharge() && r->getType() == e->getType() ) ;
+      ++nCreated ;
+    }
+
+    if( ! same ) {
+      streamlog_out(ERROR) << " event " << _nEvt << " " << what << " : particle " << i << " differs" << std::endl ;
+      ++_nErrors ;
+    }
+
+    delete recs[i] ;
+    delete expected[i] ;
+  }
+
+  if( ! recs.empty() && nCreated == 0 ) {
+    streamlog_out(ERROR) << " event " << _nEvt << " " << what << " : no particles created" << std::endl ;
+    ++_nErrors ;
+  }
+
+  _nParticles += recs.size() ;
+
+  recs.clear() ;
+  expected.clear() ;
+}
+
+
+void TestFastMCThreads::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " compared " << _nParticles << " particles of " << _nEvt << " events - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
+
+#endif // MARLIN_CLHEP
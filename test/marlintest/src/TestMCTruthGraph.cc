@@ -0,0 +1,222 @@
+#include "TestMCTruthGraph.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/MCTruthGraph.h"
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/MCParticle.h"
+#include "IMPL/LCCollectionVec.h"
+#include "IMPL/MCParticleImpl.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestMCTruthGraph aTestMCTruthGraph ;
+
+
+namespace {
+
+  /** Particles with n-1 links: particle k has the parent (k-1)/2, every fifth particle also
+   *  the parent k-2 - the particles without daughters are stable.
+   */
+  LCCollectionVec* generateParticles( unsigned n ) {
+
+    LCCollectionVec* col = new LCCollectionVec( LCIO::MCPARTICLE ) ;
+    std::vector<MCParticleImpl*> mcps( n ) ;
+
+    for( unsigned k=0 ; k < n ; ++k ) {
+
+      mcps[k] = new MCParticleImpl ;
+      mcps[k]->setPDG( 211 ) ;
+      mcps[k]->setGeneratorStatus( 2 * k + 1 < n ? 2 : 1 ) ;
+
+      if( k > 0 )
+	mcps[k]->addParent( mcps[ ( k - 1 ) / 2 ] ) ;
+
+      if( k > 2 && k % 5 == 0 )
+	mcps[k]->addParent( mcps[ k - 2 ] ) ;
+    }
+
+    // the collection in reverse order - the graph has to sort the particles
+    for( unsigned k=n ; k > 0 ; --k )
+      col->addElement( mcps[ k - 1 ] ) ;
+
+    return col ;
+  }
+}
+
+
+TestMCTruthGraph::TestMCTruthGraph() : Processor("TestMCTruthGraph") {
+
+  _description = "TestMCTruthGraph compares the MCTruthGraph with walks along the MCParticle links" ;
+
+  registerInputCollection( LCIO::MCPARTICLE,
+			   "MCParticleCollection" ,
+			   "Name of the MCParticle collection"  ,
+			   _colName ,
+			   std::string("MCParticle") ) ;
+}
+
+
+void TestMCTruthGraph::init() {
+
+  // with the ancestor bitsets and with the walk along the parents
+  const unsigned sizes[2] = { 1000, unsigned( MCTruthGraph::maxAncestorBits + 100 ) } ;
+  const unsigned steps[2] = { 1, 101 } ;
+
+  for( unsigned i=0 ; i < 2 ; ++i ) {
+
+    std::unique_ptr<LCCollectionVec> col( generateParticles( sizes[i] ) ) ;
+
+    checkGraph( col.get(), steps[i], sizes[i] <= MCTruthGraph::maxAncestorBits ) ;
+
+    ++_nGenerated ;
+  }
+}
+
+
+void TestMCTruthGraph::processEvent( LCEvent * evt ) {
+
+  const LCCollection* col = evt->getCollection( _colName ) ;
+
+  checkGraph( col, 1, unsigned( col->getNumberOfElements() ) <= MCTruthGraph::maxAncestorBits ) ;
+
+  ++_nEvt ;
+}
+
+
+void TestMCTruthGraph::checkGraph( const LCCollection* col, unsigned step, bool ancestorBits ) {
+
+  MCTruthGraph graph( col ) ;
+
+  const unsigned n = col->getNumberOfElements() ;
+
+  std::map< const MCParticle*, unsigned > index ;
+  for( unsigned i=0 ; i < n ; ++i )
+    index[ static_cast<MCParticle*>( col->getElementAt( i ) ) ] = i ;
+
+  if( graph.size() != n || graph.hasAncestorBits() != ancestorBits ) {
+    streamlog_out(ERROR) << " graph of " << n << " particles has size " << graph.size()
+			 << " ancestor bits " << graph.hasAncestorBits() << std::endl ;
+    ++_nErrors ;
+    return ;
+  }
+
+  // ---- topological order: every particle once, parents before daughters
+  const std::vector<unsigned>& order = graph.topologicalOrder() ;
+  std::vector<unsigned> position( n, n ) ;
+
+  for( unsigned k=0 ; k < order.size() ; ++k ) {
+    if( order[k] < n )
+      position[ order[k] ] = k ;
+  }
+
+  for( unsigned i=0 ; i < n ; ++i ) {
+
+    const MCParticle* mcp = static_cast<MCParticle*>( col->getElementAt( i ) ) ;
+
+    if( graph.index( mcp ) != i || position[i] == n ) {
+      streamlog_out(ERROR) << " particle " << i << " has index " << graph.index( mcp )
+			   << " and is " << ( position[i] == n ? "not " : "" ) << "in the topological order" << std::endl ;
+      ++_nErrors ;
+      continue ;
+    }
+
+    const MCParticleVec& parents = mcp->getParents() ;
+
+    for( unsigned k=0 ; k < parents.size() ; ++k ) {
+
+      const unsigned p = index[ parents[k] ] ;
+
+      if( position[p] >= position[i] || graph.depth( p ) >= graph.depth( i ) ) {
+	streamlog_out(ERROR) << " parent " << p << " of particle " << i << " is not before it in the topological order" << std::endl ;
+	++_nErrors ;
+      }
+    }
+
+    if( parents.empty() != ( graph.depth( i ) == 0 ) || ! graph.parents( i ).empty() != ( graph.primary( i ) != i ) ) {
+      streamlog_out(ERROR) << " particle " << i << " has depth " << graph.depth( i ) << " and primary " << graph.primary( i )
+			   << " but " << parents.size() << " parents" << std::endl ;
+      ++_nErrors ;
+    }
+  }
+
+  // ---- ancestors and stable descendants
+  for( unsigned d=0 ; d < n ; d += step ) {
+
+    // walk along the links of the particles
+    std::set<unsigned> ancestors ;
+    std::set<unsigned> stable ;
+
+    std::vector<const MCParticle*> stack( 1, static_cast<MCParticle*>( col->getElementAt( d ) ) ) ;
+    while( ! stack.empty() ) {
+      const MCParticleVec& parents = stack.back()->getParents() ;
+      stack.pop_back() ;
+      for( unsigned k=0 ; k < parents.size() ; ++k ) {
+	if( ancestors.insert( index[ parents[k] ] ).second )
+	  stack.push_back( parents[k] ) ;
+      }
+    }
+
+    std::set<unsigned> visited ;
+    stack.assign( 1, static_cast<MCParticle*>( col->getElementAt( d ) ) ) ;
+    while( ! stack.empty() ) {
+      const MCParticleVec& daughters = stack.back()->getDaughters() ;
+      stack.pop_back() ;
+      for( unsigned k=0 ; k < daughters.size() ; ++k ) {
+	if( visited.insert( index[ daughters[k] ] ).second ) {
+	  if( daughters[k]->getGeneratorStatus() == 1 )
+	    stable.insert( index[ daughters[k] ] ) ;
+	  stack.push_back( daughters[k] ) ;
+	}
+      }
+    }
+
+    std::vector<unsigned> result ;
+    graph.ancestors( d, result ) ;
+
+    if( std::set<unsigned>( result.begin(), result.end() ) != ancestors || result.size() != ancestors.size() ) {
+      streamlog_out(ERROR) << " particle " << d << " has " << result.size() << " ancestors instead of " << ancestors.size() << std::endl ;
+      ++_nErrors ;
+    }
+
+    for( unsigned a=0 ; a < n ; ++a ) {
+      if( graph.isAncestor( a, d ) != ( ancestors.count( a ) > 0 ) ) {
+	streamlog_out(ERROR) << " isAncestor( " << a << ", " << d << " ) is " << graph.isAncestor( a, d ) << std::endl ;
+	++_nErrors ;
+      }
+    }
+
+    if( graph.primary( d ) != d && ! ancestors.count( graph.primary( d ) ) ) {
+      streamlog_out(ERROR) << " primary " << graph.primary( d ) << " is not an ancestor of " << d << std::endl ;
+      ++_nErrors ;
+    }
+
+    result.clear() ;
+    graph.stableDescendants( d, result ) ;
+
+    if( std::set<unsigned>( result.begin(), result.end() ) != stable || result.size() != stable.size() ) {
+      streamlog_out(ERROR) << " particle " << d << " has " << result.size() << " stable descendants instead of " << stable.size() << std::endl ;
+      ++_nErrors ;
+    }
+  }
+}
+
+
+void TestMCTruthGraph::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " checked the graphs of " << _nEvt << " events and " << _nGenerated << " generated graphs - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
@@ -0,0 +1,57 @@
+#include "TestParallelInit.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestParallelInit aTestParallelInit ;
+
+
+namespace {
+  // number of instances that entered init()
+  std::atomic<int> nInInit( 0 ) ;
+}
+
+
+TestParallelInit::TestParallelInit() : Processor("TestParallelInit") {
+
+  _description = "TestParallelInit writes streamlog and std::cout output in init() - for the concurrent init() of independent processors" ;
+
+  setIndependentInit() ;
+}
+
+
+void TestParallelInit::init() {
+
+  const int nInstances = 2 ;
+
+  ++nInInit ;
+
+  // the other instance only runs concurrently if there is more than one hardware thread
+  for( int i=0 ; i < 100 && nInInit < nInstances ; ++i )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) ) ;
+
+  _concurrent = ( nInInit >= nInstances ) ;
+
+  for( int i=0 ; i < 3 ; ++i ) {
+    streamlog_out(DEBUG) << "debug output of " << name() << std::endl ;
+    streamlog_out(MESSAGE) << "message output of " << name() << std::endl ;
+    std::cout << "line " << i << " of " << name() << std::endl ;
+  }
+}
+
+
+void TestParallelInit::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << ( _concurrent ? " init() ran concurrently" : " init() did not run concurrently" )
+			  << std::endl ;
+}
@@ -0,0 +1,119 @@
+#include "TestPolarAngleBinning.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/PolarAngleBinning.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestPolarAngleBinning aTestPolarAngleBinning ;
+
+
+namespace {
+
+  typedef std::vector< std::pair<double,double> > Ranges ;
+
+  /** Index of the first range (thMin,thMax] containing theta - -1 if there is none */
+  int linearSearch( const Ranges& ranges, double theta ) {
+
+    for( unsigned i=0 ; i < ranges.size() ; ++i ) {
+      if( theta > ranges[i].first && theta <= ranges[i].second )
+	return i ;
+    }
+    return -1 ;
+  }
+}
+
+
+TestPolarAngleBinning::TestPolarAngleBinning() : Processor("TestPolarAngleBinning") {
+
+  _description = "TestPolarAngleBinning compares the PolarAngleBinning with a linear search" ;
+}
+
+
+void TestPolarAngleBinning::init() {
+
+  // a single range as in the defaults of the SimpleFastMCProcessor, adjacent ranges
+  checkRanges( { { 0., 3.141593/2. } }, 10000 ) ;
+  checkRanges( { { 0.08, M_PI/2. }, { M_PI/2., M_PI - 0.08 } }, 10000 ) ;
+
+  // overlapping - the first range has priority
+  checkRanges( { { 0., 1. }, { 0.5, 2. }, { 1.5, 3. }, { 0.2, 0.7 }, { 0., M_PI } }, 10000 ) ;
+
+  // gaps and unsorted ranges
+  checkRanges( { { 2., 3. }, { 0., 0.5 }, { 1., 1.5 } }, 10000 ) ;
+
+  // empty ranges are ignored
+  checkRanges( { { 1., 1. }, { 2., 1. }, { 0., 1. }, { 1.5, 1.5 } }, 10000 ) ;
+  checkRanges( { { 1., 1. }, { 2., 1. } }, 1000 ) ;
+  checkRanges( {}, 1000 ) ;
+
+  // finely binned map with random overlapping ranges
+  std::mt19937 engine( 42 ) ;
+  std::uniform_real_distribution<double> uniform( 0., M_PI ) ;
+
+  Ranges ranges ;
+  for( unsigned i=0 ; i < 500 ; ++i ) {
+    const double a = uniform( engine ) ;
+    ranges.push_back( std::make_pair( a, a + 0.05 * uniform( engine ) ) ) ;
+  }
+  checkRanges( ranges, 100000 ) ;
+}
+
+
+void TestPolarAngleBinning::checkRanges( const Ranges& ranges, unsigned n ) {
+
+  PolarAngleBinning bins ;
+  bins.init( ranges ) ;
+
+  // the edges, the neighbouring values and random angles within and outside of [0,pi]
+  std::vector<double> thetas ;
+
+  for( unsigned i=0 ; i < ranges.size() ; ++i ) {
+
+    const double edges[2] = { ranges[i].first, ranges[i].second } ;
+
+    for( unsigned k=0 ; k < 2 ; ++k ) {
+      thetas.push_back( edges[k] ) ;
+      thetas.push_back( std::nextafter( edges[k], -1. ) ) ;
+      thetas.push_back( std::nextafter( edges[k], 4. ) ) ;
+    }
+  }
+
+  thetas.push_back( std::numeric_limits<double>::quiet_NaN() ) ;
+
+  std::mt19937 engine( 4711 ) ;
+  std::uniform_real_distribution<double> uniform( -0.1, M_PI + 0.1 ) ;
+
+  while( thetas.size() < n )
+    thetas.push_back( uniform( engine ) ) ;
+
+  for( unsigned k=0 ; k < thetas.size() ; ++k ) {
+
+    if( bins.index( thetas[k] ) != linearSearch( ranges, thetas[k] ) ) {
+
+      streamlog_out(ERROR) << " binning " << _nBinnings << " theta " << thetas[k] << " : index " << bins.index( thetas[k] )
+			   << " instead of " << linearSearch( ranges, thetas[k] ) << std::endl ;
+      ++_nErrors ;
+    }
+  }
+
+  _nAngles += thetas.size() ;
+  ++_nBinnings ;
+}
+
+
+void TestPolarAngleBinning::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " compared " << _nAngles << " angles in " << _nBinnings << " binnings - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
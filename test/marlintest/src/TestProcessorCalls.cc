@@ -0,0 +1,136 @@
+#include "TestProcessorCalls.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/Global.h"
+#include "marlin/ProcessorEventSeeder.h"
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestProcessorCalls aTestProcessorCalls ;
+
+
+namespace {
+  // number of events all instances have been called for
+  int nEventCalls = 0 ;
+}
+
+
+TestProcessorCalls::TestProcessorCalls() : Processor("TestProcessorCalls") {
+
+  _description = "TestProcessorCalls counts the calls of the processor and compares them with the expected ones" ;
+
+  registerProcessorParameter( "ExpectedEvents" ,
+			      "Number of events the processor has to be called for - -1 for any"  ,
+			      _expectedEvents ,
+			      int( -1 ) ) ;
+
+  registerProcessorParameter( "SkipEvent" ,
+			      "Index of the call in which skipEvent() is called - -1 for none"  ,
+			      _skipEvent ,
+			      int( -1 ) ) ;
+
+  registerProcessorParameter( "StopEvent" ,
+			      "Index of the call in which requestStop() is called - -1 for none"  ,
+			      _stopEvent ,
+			      int( -1 ) ) ;
+
+  registerProcessorParameter( "ReturnTrueFromEvent" ,
+			      "Index of the first call that sets the return value to true"  ,
+			      _returnTrueFromEvent ,
+			      int( 0 ) ) ;
+
+  registerProcessorParameter( "ExpectedCallsBeforeInit" ,
+			      "Number of events all TestProcessorCalls are called for before init() - -1 for any"  ,
+			      _expectedCallsBeforeInit ,
+			      int( -1 ) ) ;
+
+  registerProcessorParameter( "RegisterSeeder" ,
+			      "Register with the ProcessorEventSeeder and compare the seeds in processEvent()"  ,
+			      _registerSeeder ,
+			      bool( false ) ) ;
+
+  registerInputCollection( LCIO::MCPARTICLE,
+			   "InputCollection" ,
+			   "Name of an input collection the processor needs (SkipWithoutInputs) - not read"  ,
+			   _colName ,
+			   std::string("") ) ;
+}
+
+
+void TestProcessorCalls::init() {
+
+  ++_nInit ;
+
+  if( _expectedCallsBeforeInit >= 0 && nEventCalls != _expectedCallsBeforeInit ) {
+    streamlog_out(ERROR) << " init() called after " << nEventCalls << " events instead of " << _expectedCallsBeforeInit << std::endl ;
+    ++_nErrors ;
+  }
+
+  if( _registerSeeder )
+    Global::EVENTSEEDER->registerProcessor( this ) ;
+}
+
+
+void TestProcessorCalls::processRunHeader( LCRunHeader* ) {
+
+  if( _nInit != 1 ) {
+    streamlog_out(ERROR) << " processRunHeader() called after " << _nInit << " calls of init()" << std::endl ;
+    ++_nErrors ;
+  }
+
+  ++_nRun ;
+}
+
+
+void TestProcessorCalls::processEvent( LCEvent * evt ) {
+
+  if( _nInit != 1 ) {
+    streamlog_out(ERROR) << " processEvent() called after " << _nInit << " calls of init()" << std::endl ;
+    ++_nErrors ;
+  }
+
+  if( _nRun == 0 ) {
+    streamlog_out(ERROR) << " processEvent() called before processRunHeader()" << std::endl ;
+    ++_nErrors ;
+  }
+
+  // the seed of the event does not depend on the time of the registration
+  if( _registerSeeder && Global::EVENTSEEDER->getSeed( this ) != Global::EVENTSEEDER->getSeed( this, evt ) ) {
+    streamlog_out(ERROR) << " wrong seed in event " << evt->getEventNumber() << std::endl ;
+    ++_nErrors ;
+  }
+
+  ++nEventCalls ;
+
+  const int index = _nEvt++ ;
+
+  setReturnValue( index >= _returnTrueFromEvent ) ;
+
+  if( index == _skipEvent ) {
+    skipEvent() ;
+    return ;
+  }
+
+  if( index == _stopEvent ) {
+    requestStop() ;
+    return ;
+  }
+}
+
+
+void TestProcessorCalls::end(){
+
+  if( _expectedEvents >= 0 && _nEvt != _expectedEvents ) {
+    streamlog_out(ERROR) << " called in " << _nEvt << " events instead of " << _expectedEvents << std::endl ;
+    ++_nErrors ;
+  }
+
+  streamlog_out(MESSAGE4) << name()
+			  << " called in " << _nEvt << " events - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
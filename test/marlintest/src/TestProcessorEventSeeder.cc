@@ -57,6 +57,28 @@ void TestProcessorEventSeeder::processEvent( LCEvent * evt ) {
 			    << evt->getEventNumber()
 			    << std::endl;
 
+  // the counter based seeds must not depend on the state of the seeder
+  if( Global::EVENTSEEDER->seedingMode() == ProcessorEventSeeder::PHILOX ) {
+
+    unsigned int evtSeed = Global::EVENTSEEDER->getSeed( this, evt ) ;
+
+    RandomStream s1 = Global::EVENTSEEDER->getRandomStream( this ) ;
+    RandomStream s2 = Global::EVENTSEEDER->getRandomStream( this, evt ).substream( 42 ) ;
+
+    s1() ;  // substreams are independent of the numbers drawn from the parent stream
+
+    RandomStream s3 = s1.substream( 42 ) ;
+
+    if( evtSeed != seed || s2() != s3() ) {
+      streamlog_out(ERROR) << " Seeds don't match for"
+			   << " run " <<   evt->getRunNumber()
+			   << " event " << evt->getEventNumber()
+			   << " getSeed( this ) = " << seed 
+			   << " getSeed( this, evt ) = " << evtSeed  
+			   << std::endl ;      
+    }
+  }
+
   try{
     Global::EVENTSEEDER->registerProcessor(this);
   }
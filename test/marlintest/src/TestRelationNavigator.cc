@@ -0,0 +1,142 @@
+#include "TestRelationNavigator.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCRelation.h"
+#include "IMPL/LCCollectionVec.h"
+#include "IMPL/LCRelationImpl.h"
+#include "UTIL/LCRelationNavigator.h"
+
+#include <set>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestRelationNavigator aTestRelationNavigator ;
+
+
+TestRelationNavigator::TestRelationNavigator() : Processor("TestRelationNavigator") {
+
+  _description = "TestRelationNavigator compares the RelationNavigator with UTIL::LCRelationNavigator" ;
+
+  registerInputCollection( LCIO::MCPARTICLE,
+			   "MCParticleCollection" ,
+			   "Name of the MCParticle collection"  ,
+			   _colName ,
+			   std::string("MCParticle") ) ;
+}
+
+
+void TestRelationNavigator::processEvent( LCEvent * evt ) {
+
+  // ---- the relation collections of the event
+  const std::vector<std::string>* names = evt->getCollectionNames() ;
+
+  for( size_t k=0 ; k < names->size() ; ++k ) {
+
+    const LCCollection* col = evt->getCollection( (*names)[k] ) ;
+
+    if( col->getTypeName() != LCIO::LCRELATION )
+      continue ;
+
+    UTIL::LCRelationNavigator expected( col ) ;
+
+    compare( *RelationNavigator::get( evt, (*names)[k], RelationNavigator::FROM_TO ), expected, col, (*names)[k] ) ;
+    compare( *RelationNavigator::get( evt, (*names)[k], RelationNavigator::TO_FROM ), expected, col, (*names)[k] ) ;
+  }
+
+  // ---- relations between the MCParticles - every third pair twice, not adjacent in the collection
+  const LCCollection* mcps = evt->getCollection( _colName ) ;
+  const int n = mcps->getNumberOfElements() ;
+
+  LCCollectionVec col( LCIO::LCRELATION ) ;
+  col.parameters().setValue( "FromType", std::string( LCIO::MCPARTICLE ) ) ;
+  col.parameters().setValue( "ToType", std::string( LCIO::MCPARTICLE ) ) ;
+
+  for( int i=0 ; i < n ; ++i ) {
+    col.addElement( new LCRelationImpl( mcps->getElementAt( i ), mcps->getElementAt( ( 3 * i + 1 ) % n ), 0.5f + i ) ) ;
+    col.addElement( new LCRelationImpl( mcps->getElementAt( i ), mcps->getElementAt( ( 7 * i + 2 ) % n ), 0.25f ) ) ;
+  }
+  for( int i=0 ; i < n ; i += 3 )
+    col.addElement( new LCRelationImpl( mcps->getElementAt( i ), mcps->getElementAt( ( 3 * i + 1 ) % n ), 0.125f * i ) ) ;
+
+  UTIL::LCRelationNavigator expected( &col ) ;
+
+  compare( RelationNavigator( &col, RelationNavigator::FROM_TO ), expected, &col, "duplicated MCParticle relations" ) ;
+  compare( RelationNavigator( &col, RelationNavigator::TO_FROM ), expected, &col, "duplicated MCParticle relations" ) ;
+
+  ++_nEvt ;
+}
+
+
+void TestRelationNavigator::compare( const RelationNavigator& nav, const UTIL::LCRelationNavigator& expected,
+				     const LCCollection* col, const std::string& colName ) {
+
+  const bool fromTo = ( nav.direction() == RelationNavigator::FROM_TO ) ;
+
+  if( nav.sourceType() != ( fromTo ? expected.getFromType() : expected.getToType() ) ||
+      nav.relatedType() != ( fromTo ? expected.getToType() : expected.getFromType() ) ) {
+    streamlog_out(ERROR) << " event " << _nEvt << " " << colName << " : types " << nav.sourceType()
+			 << " - " << nav.relatedType() << std::endl ;
+    ++_nErrors ;
+  }
+
+  size_t nRelations = 0 ;
+  std::set<const LCObject*> sources ;
+
+  for( int i=0 ; i < col->getNumberOfElements() ; ++i ) {
+
+    const LCRelation* rel = static_cast<LCRelation*>( col->getElementAt( i ) ) ;
+    LCObject* source = ( fromTo ? rel->getFrom() : rel->getTo() ) ;
+
+    const RelationNavigator::Range related = nav.related( source ) ;
+
+    const LCObjectVec& objects = ( fromTo ? expected.getRelatedToObjects( source ) : expected.getRelatedFromObjects( source ) ) ;
+    const FloatVec& weights = ( fromTo ? expected.getRelatedToWeights( source ) : expected.getRelatedFromWeights( source ) ) ;
+
+    bool same = ( related.size() == objects.size() ) ;
+
+    // the same order and the same sums of the weights
+    for( size_t j=0 ; same && j < objects.size() ; ++j )
+      same = ( related[j] == objects[j] && related.weight(j) == weights[j] ) ;
+
+    if( ! same ) {
+      streamlog_out(ERROR) << " event " << _nEvt << " " << colName << ( fromTo ? " from-to" : " to-from" )
+			   << " : relation " << i << " has " << related.size() << " related objects instead of "
+			   << objects.size() << " or different weights" << std::endl ;
+      ++_nErrors ;
+    }
+
+    // every source counted once
+    if( sources.insert( source ).second )
+      nRelations += objects.size() ;
+
+    // a relation is not a source
+    if( ! nav.related( rel ).empty() ) {
+      streamlog_out(ERROR) << " event " << _nEvt << " " << colName << " : objects related to relation " << i << std::endl ;
+      ++_nErrors ;
+    }
+  }
+
+  if( nav.size() != nRelations ) {
+    streamlog_out(ERROR) << " event " << _nEvt << " " << colName << " : " << nav.size()
+			 << " relations instead of " << nRelations << std::endl ;
+    ++_nErrors ;
+  }
+
+  ++_nCollections ;
+}
+
+
+void TestRelationNavigator::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " compared " << _nCollections << " navigators of " << _nEvt << " events - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
@@ -0,0 +1,240 @@
+#include "TestSpatialIndex.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/SimCalorimeterHit.h"
+#include "IMPL/CalorimeterHitImpl.h"
+#include "IMPL/LCCollectionVec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestSpatialIndex aTestSpatialIndex ;
+
+
+namespace {
+
+  const int nLayers = 5 ;
+
+  const SpatialIndex::Type types[3] = { SpatialIndex::UNIFORM_GRID, SpatialIndex::KD_TREE, SpatialIndex::LAYER_GRID } ;
+
+  // the same arithmetic as the index
+  float distance2( const HitSoAView& hits, size_t i, const float* p ) {
+
+    const float dx = hits.x()[i] - p[0] ;
+    const float dy = hits.y()[i] - p[1] ;
+    const float dz = hits.z()[i] - p[2] ;
+    return dx * dx + dy * dy + dz * dz ;
+  }
+}
+
+
+TestSpatialIndex::TestSpatialIndex() : Processor("TestSpatialIndex") {
+
+  _description = "TestSpatialIndex compares the SpatialIndex types with a brute-force neighbour search" ;
+
+  registerInputCollection( LCIO::SIMCALORIMETERHIT,
+			   "CollectionName" ,
+			   "Name of the SimCalorimeterHit collection"  ,
+			   _colName ,
+			   std::string("ECAL007") ) ;
+}
+
+
+void TestSpatialIndex::init() {
+
+  const float inf = std::numeric_limits<float>::infinity() ;
+  const float nan = std::numeric_limits<float>::quiet_NaN() ;
+
+  const float positions[3][3] = { { 1.f, 2.f, 3.f }, { inf, 0.f, 0.f }, { 0.f, nan, 0.f } } ;
+
+  for( int k=1 ; k < 3 ; ++k ) {
+
+    LCCollectionVec col( LCIO::CALORIMETERHIT ) ;
+
+    for( int i=0 ; i < 2 ; ++i ) {
+      CalorimeterHitImpl* hit = new CalorimeterHitImpl ;
+      hit->setPosition( positions[ i == 0 ? 0 : k ] ) ;
+      col.addElement( hit ) ;
+    }
+
+    std::shared_ptr<const HitSoAView> hits = std::make_shared<const HitSoAView>( &col ) ;
+
+    for( int t=0 ; t < 3 ; ++t ) {
+
+      bool thrown = false ;
+      try{
+	SpatialIndex index( hits, types[t], 10.f, "layer:8" ) ;
+      }
+      catch( lcio::Exception& ) {
+	thrown = true ;
+      }
+      if( ! thrown ) {
+	streamlog_out(ERROR) << " no exception for a hit at " << positions[k][0] << "," << positions[k][1]
+			     << "," << positions[k][2] << " - index type " << types[t] << std::endl ;
+	++_nErrors ;
+      }
+    }
+  }
+}
+
+
+void TestSpatialIndex::processEvent( LCEvent * evt ) {
+
+  const LCCollection* simHits = evt->getCollection( _colName ) ;
+
+  // a CalorimeterHit collection with the positions and a layer field - the first hit twice
+  LCCollectionVec* col = new LCCollectionVec( LCIO::CALORIMETERHIT ) ;
+  col->parameters().setValue( LCIO::CELLIDENCODING, std::string("layer:8,hit:24") ) ;
+
+  const int nSimHits = simHits->getNumberOfElements() ;
+
+  for( int i=0 ; i <= nSimHits && nSimHits > 0 ; ++i ) {
+
+    const SimCalorimeterHit* sim = static_cast<SimCalorimeterHit*>( simHits->getElementAt( i < nSimHits ? i : 0 ) ) ;
+
+    CalorimeterHitImpl* hit = new CalorimeterHitImpl ;
+    hit->setPosition( sim->getPosition() ) ;
+    hit->setEnergy( sim->getEnergy() ) ;
+    hit->setCellID0( ( i % nLayers ) | ( i << 8 ) ) ;
+    col->addElement( hit ) ;
+  }
+
+  const std::string colName = name() + "Hits" ;
+  evt->addCollection( col, colName ) ;
+
+  std::shared_ptr<const HitSoAView> hits = HitSoAView::get( evt, colName ) ;
+
+  // the cell size and the radii scale with the extent of the hits
+  float min[3] = { 0.f, 0.f, 0.f } ;
+  float max[3] = { 0.f, 0.f, 0.f } ;
+
+  const float* coord[3] = { hits->x(), hits->y(), hits->z() } ;
+
+  for( int d=0 ; d < 3 ; ++d ) {
+    for( size_t i=0 ; i < hits->size() ; ++i ) {
+      min[d] = ( i == 0 ? coord[d][i] : std::min( min[d], coord[d][i] ) ) ;
+      max[d] = ( i == 0 ? coord[d][i] : std::max( max[d], coord[d][i] ) ) ;
+    }
+  }
+
+  float extent = std::sqrt( ( max[0] - min[0] ) * ( max[0] - min[0] ) + ( max[1] - min[1] ) * ( max[1] - min[1] )
+			    + ( max[2] - min[2] ) * ( max[2] - min[2] ) ) ;
+  if( extent <= 0.f )
+    extent = 1.f ;
+
+  const float cellSize = extent / 20.f ;
+
+  std::vector<SpatialIndex::Request> requests ;
+  for( int t=0 ; t < 3 ; ++t )
+    requests.push_back( { colName, types[t], cellSize } ) ;
+
+  SpatialIndex::prepare( evt, requests ) ;
+
+  const float radii[4] = { 0.f, 0.02f * extent, 0.1f * extent, 0.5f * extent } ;
+
+  for( int t=0 ; t < 3 ; ++t ) {
+
+    std::shared_ptr<const SpatialIndex> index = SpatialIndex::get( evt, colName, types[t], cellSize ) ;
+
+    // the hits, the midpoints of neighbouring hits and points outside the extent
+    for( size_t i=0 ; i < hits->size() ; ++i ) {
+
+      const size_t j = ( i + 1 ) % hits->size() ;
+
+      const float points[3][3] = {
+	{ hits->x()[i], hits->y()[i], hits->z()[i] } ,
+	{ 0.5f * ( hits->x()[i] + hits->x()[j] ), 0.5f * ( hits->y()[i] + hits->y()[j] ), 0.5f * ( hits->z()[i] + hits->z()[j] ) } ,
+	{ hits->x()[i] - extent, hits->y()[i] + 0.5f * extent, max[2] + 0.1f * extent }
+      } ;
+
+      for( int k=0 ; k < 3 ; ++k ) {
+	for( int r=0 ; r < 4 ; ++r )
+	  compare( *index, points[k], radii[r] ) ;
+      }
+    }
+  }
+
+  ++_nEvt ;
+}
+
+
+void TestSpatialIndex::compare( const SpatialIndex& index, const float* p, float radius ) {
+
+  const HitSoAView& hits = index.hits() ;
+  const float r2 = radius * radius ;
+
+  std::vector<size_t> expected[ nLayers + 1 ] ;
+  size_t nearest = hits.size() ;
+  float nearest2 = std::numeric_limits<float>::max() ;
+
+  for( size_t i=0 ; i < hits.size() ; ++i ) {
+
+    const float dist2 = distance2( hits, i, p ) ;
+
+    if( dist2 <= r2 ) {
+      expected[ nLayers ].push_back( i ) ;
+      expected[ hits.cellID()[i] & 0xff ].push_back( i ) ;
+    }
+    if( dist2 < nearest2 ) {
+      nearest2 = dist2 ;
+      nearest = i ;
+    }
+  }
+
+  std::vector<size_t> result ;
+  index.findNeighbours( p[0], p[1], p[2], radius, result ) ;
+  std::sort( result.begin(), result.end() ) ;
+
+  if( result != expected[ nLayers ] ) {
+    streamlog_out(ERROR) << " event " << _nEvt << " index type " << index.type() << " : " << result.size()
+			 << " neighbours within " << radius << " instead of " << expected[ nLayers ].size() << std::endl ;
+    ++_nErrors ;
+  }
+
+  if( index.type() == SpatialIndex::LAYER_GRID ) {
+
+    for( int l=0 ; l < nLayers ; ++l ) {
+
+      result.clear() ;
+      index.findNeighboursInLayer( l, p[0], p[1], p[2], radius, result ) ;
+      std::sort( result.begin(), result.end() ) ;
+
+      if( result != expected[l] ) {
+	streamlog_out(ERROR) << " event " << _nEvt << " layer " << l << " : " << result.size()
+			     << " neighbours within " << radius << " instead of " << expected[l].size() << std::endl ;
+	++_nErrors ;
+      }
+    }
+  }
+
+  // several hits may be closest
+  const size_t n = index.nearest( p[0], p[1], p[2] ) ;
+
+  if( ( n < hits.size() ) != ( nearest < hits.size() ) || ( n < hits.size() && distance2( hits, n, p ) != nearest2 ) ) {
+    streamlog_out(ERROR) << " event " << _nEvt << " index type " << index.type() << " : nearest hit " << n
+			 << " instead of " << nearest << std::endl ;
+    ++_nErrors ;
+  }
+
+  ++_nQueries ;
+}
+
+
+void TestSpatialIndex::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " compared " << _nQueries << " queries of " << _nEvt << " events - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}
@@ -0,0 +1,151 @@
+#include "TestZigguratGaussian.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/PhiloxRandom.h"
+#include "marlin/ZigguratGaussian.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestZigguratGaussian aTestZigguratGaussian ;
+
+
+namespace {
+
+  /** Fraction of a standard normal distribution above x */
+  double upperTail( double x ) {
+    return 0.5 * std::erfc( x / std::sqrt( 2. ) ) ;
+  }
+}
+
+
+TestZigguratGaussian::TestZigguratGaussian() : Processor("TestZigguratGaussian") {
+
+  _description = "TestZigguratGaussian checks the distribution of the ZigguratGaussian random numbers" ;
+
+  registerProcessorParameter( "NumberOfRandomNumbers" ,
+			      "Number of random numbers drawn"  ,
+			      _nNumbers ,
+			      int( 1000000 ) ) ;
+}
+
+
+void TestZigguratGaussian::init() {
+
+  const size_t n = _nNumbers > 0 ? _nNumbers : 1 ;
+
+  RandomStream stream( {{ 1234567890u, 42u }} , {{ 1u, 2u, 0u, 0u }} ) ;
+
+  std::vector<double> x( n ) ;
+  ZigguratGaussian::shootArray( stream, n, x.data() ) ;
+
+  // ---- shootArray() and shoot() give the same numbers from the same stream
+  RandomStream same( {{ 1234567890u, 42u }} , {{ 1u, 2u, 0u, 0u }} ) ;
+
+  for( size_t i=0 ; i < std::min< size_t >( n, 1000 ) ; ++i ) {
+
+    const double y = ZigguratGaussian::shoot( same, 10., 2. ) ;
+
+    if( std::fabs( y - ( 10. + 2. * x[i] ) ) > 1e-12 ) {
+      streamlog_out(ERROR) << " number " << i << " of shoot() is " << y << " instead of " << 10. + 2. * x[i] << std::endl ;
+      ++_nErrors ;
+      break ;
+    }
+  }
+
+  // ---- moments - the limits are five standard deviations of the estimates
+  double sum[4] = { 0., 0., 0., 0. } ;
+
+  for( size_t i=0 ; i < n ; ++i ) {
+    const double x2 = x[i] * x[i] ;
+    sum[0] += x[i] ;
+    sum[1] += x2 ;
+    sum[2] += x2 * x[i] ;
+    sum[3] += x2 * x2 ;
+  }
+
+  const double mean = sum[0] / n ;
+  const double variance = sum[1] / n ;
+  const double skewness = sum[2] / n ;
+  const double kurtosis = sum[3] / n - 3. ;
+
+  const double moments[4] = { mean, variance - 1., skewness, kurtosis } ;
+  const double limits[4] = { 5. * std::sqrt( 1. / n ), 5. * std::sqrt( 2. / n ), 5. * std::sqrt( 15. / n ), 5. * std::sqrt( 96. / n ) } ;
+  const char* names[4] = { "mean", "variance - 1", "skewness", "excess kurtosis" } ;
+
+  for( unsigned k=0 ; k < 4 ; ++k ) {
+    if( std::fabs( moments[k] ) > limits[k] ) {
+      streamlog_out(ERROR) << " " << names[k] << " is " << moments[k] << " - limit " << limits[k] << std::endl ;
+      ++_nErrors ;
+    }
+  }
+
+  // ---- shape: fractions in bins of 0.25 sigma and in the tails beyond the ziggurat base
+  // layer (r = 3.44) and beyond 4 and 5 sigma - chi2 of the counts
+  std::vector<double> edges ;
+  for( int k=-16 ; k <= 16 ; ++k )
+    edges.push_back( 0.25 * k ) ;
+
+  const double tails[3] = { 3.442619855899, 4., 5. } ;
+
+  std::vector<double> counts( edges.size() + 1, 0. ) ;
+  double tailCounts[3] = { 0., 0., 0. } ;
+
+  for( size_t i=0 ; i < n ; ++i ) {
+
+    const size_t b = std::upper_bound( edges.begin(), edges.end(), x[i] ) - edges.begin() ;
+    ++counts[b] ;
+
+    for( unsigned t=0 ; t < 3 ; ++t ) {
+      if( std::fabs( x[i] ) > tails[t] )
+	++tailCounts[t] ;
+    }
+  }
+
+  double chi2 = 0. ;
+
+  for( size_t b=0 ; b < counts.size() ; ++b ) {
+
+    const double low = ( b == 0 ? -HUGE_VAL : edges[ b - 1 ] ) ;
+    const double high = ( b == edges.size() ? HUGE_VAL : edges[b] ) ;
+
+    const double expected = n * ( upperTail( low ) - upperTail( high ) ) ;
+
+    chi2 += ( counts[b] - expected ) * ( counts[b] - expected ) / expected ;
+  }
+
+  // 33 degrees of freedom - the probability of a larger chi2 is below 1e-6
+  if( chi2 > 85. ) {
+    streamlog_out(ERROR) << " chi2 of the distribution is " << chi2 << " for " << counts.size() - 1 << " degrees of freedom" << std::endl ;
+    ++_nErrors ;
+  }
+
+  for( unsigned t=0 ; t < 3 ; ++t ) {
+
+    const double expected = 2. * n * upperTail( tails[t] ) ;
+
+    if( std::fabs( tailCounts[t] - expected ) > 5. * std::sqrt( expected ) + 1. ) {
+      streamlog_out(ERROR) << " " << tailCounts[t] << " numbers beyond " << tails[t] << " - expected " << expected << std::endl ;
+      ++_nErrors ;
+    }
+  }
+
+  streamlog_out(DEBUG) << " mean " << mean << " variance " << variance << " skewness " << skewness << " excess kurtosis " << kurtosis
+		       << " chi2 " << chi2 << " tails " << tailCounts[0] << " " << tailCounts[1] << " " << tailCounts[2] << std::endl ;
+}
+
+
+void TestZigguratGaussian::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " checked the distribution of " << _nNumbers << " random numbers - "
+			  << _nErrors << " errors"
+			  << std::endl ;
+}